@@ -13,11 +13,21 @@
 //
 // READING
 //
-// To read you need a context, there are 3 ways of getting a context:
+// To read you need a context, there are several ways of getting a context:
 //   djReadFile(File)                // Reads from an already open file handle (the whole file is read into RAM)
 //   djReadOpenAndReadFile(FilePath) // Opens a file and reads the whole file into RAM
 //   djReadFromString(JsonString)    // Reads from a string containing json, needs to be null terminated.
 //                                      And kept alive while the context is alive.
+//   djReadFromBuffer(Data, Length)  // Reads Length bytes of json, doesn't need to be null terminated so it can be 
+//                                      used directly on network buffers and shared memory. Nothing is read past 
+//                                      Data + Length. The data needs to be kept alive while the context is alive.
+//   djReadFromBinary(Data, Length, Format) // Reads MessagePack (djFORMAT_MSGPACK) or CBOR (djFORMAT_CBOR), the data
+//                                             needs to be kept alive while the context is alive. All the djRead 
+//                                             functions works the same way as for json, but strings (and keys) 
+//                                             points directly into the data and are NOT null terminated.
+//   djReadOpenAndReadGzipFile(FilePath) // Decompresses a gzip file into RAM, uncompressed files are read as is.
+//                                          Only available if DIR_JSON_ZLIB is defined and zlib is linked. To read
+//                                          large files without holding all of it in RAM use djReadFeedGzipFile.
 // Now one have a context and can read the json data, once done reading one should do:
 //   djReadError(Context) // Returns a pointer to any error that has occured, null otherwise.
 //                           Instead of checking for errors while parsing one can delay that until the end and assume
@@ -25,12 +35,29 @@
 //                           reading functions will just return 0. Only the first error will be kept.
 //   djReadDestroyContext(Context) // Frees up any resources used
 //
+// Validating without reading, checks the grammar, nesting and UTF-8 of the strings. Nothing is allocated.
+//   size_t ErrorOffset;
+//   if (!djValidate(Data, Length, &ErrorOffset)) // Returns 1 if valid, otherwise ErrorOffset is the invalid byte
+//
 // Reading integers, floating points, strings, booleans
 //   djReadBool(Context) // Returns 1 if true and 0 if false, reports an error if neither
 //   djReadS64(Context)  // Returns the integer value if a number, reports an error if not a whole number
 //   djReadF64(Context)  // Returns the decimal value if a number, reports an error if not a number
+//   djReadDecimal(Context, 2) // Returns the number multiplied by 10^2 exactly, "12.5" gives 1250
 //   djReadNull(Context) // Returns 1 if null, reports an error if it's not null
 //   djReadEOF(Context)  // Returns 1 if eof is reach, reports an error otherwise
+//   djReadString(Context) // Returns the unescaped string, \u escapes (and surrogate pairs) are encoded as UTF-8
+// Other bytes in strings are copied as is, define DIR_JSON_VALIDATE_UTF8 to report an error if they aren't UTF-8.
+// djReadDecimal never goes through floating point, the scale can be 0-18. A number with more decimals than the scale 
+// or that doesn't fit in 64 bits is reported as an error. Binary formats can contain floats which are rounded.
+//
+// Reading numbers without converting them, e.g. to pass big integers through or only convert the ones used
+//   dj_number Number = djReadNumberRaw(Context); // The grammar is checked like djReadF64
+//   if (Number.Flags == djNUMBER_INTEGER && Number.Digits > 18) // Might not fit in a dj_s64, keep it as text
+//     Id = Number.Text;
+// Number.Text points directly into the json data so it isn't null terminated and is valid while the context is. 
+// For binary formats the number is formatted into the context and only valid until the next read, infinity and 
+// NaN are reported as errors since they aren't json numbers.
 //
 // Reading arrays is as simple as
 //   while (djReadArray(Context)) {
@@ -62,11 +89,180 @@
 // djReadMandatoryKey reads the next key and verifies checks that it matches the expected. Returns 0 if anything went wrong.
 // djReadOptionalKey reads the next key if it matches the expected. Returns 1 if it matches, otherwise 0.
 // djReadObjectEnd checks that the end of the object is reached. Returns 0 if anything went wrong.
+//
+// Reading keys as IDs, the keys are looked up in a dictionary so they can be compared as integers
+//   enum { KEY_X, KEY_Y };
+//   const char* Keys[] = { "x", "y" }; // The index of a key is its ID
+//   dj_key_dictionary* Dictionary = djInitializeKeyDictionary(Keys, 2);
+//   djReadSetKeyDictionary(Context, Dictionary);
+//   int Id;
+//   while (djReadKeyId(Context, &Id)) {
+//     switch (Id) {
+//       case KEY_X: Vec.X = djReadS64(Context); break;
+//       case KEY_Y: Vec.Y = djReadS64(Context); break;
+//       default: djReadSkipValue(Context); // Id is -1 for keys that aren't in the dictionary
+//     }
+//   }
+// djReadMandatoryKeyId and djReadOptionalKeyId works like djReadMandatoryKey and djReadOptionalKey. Keys without 
+// escape sequences are looked up directly in the json data without being copied. The dictionary can be shared by
+// many contexts and needs to outlive them.
+//
+// Reading an array of objects into columns, each key is bound to a typed column and every object becomes a row.
+//   dj_column_member Members[] = { { "ts", djCOLUMN_S64 }, { "v", djCOLUMN_F64 } };
+//   dj_columns_object* Columns = djInitializeColumns(Members, 2);
+//   djReadColumns(Context, Columns); // Returns the number of rows read
+//   const dj_s64* Ts = djGetColumn(Columns, 0)->Values;
+// Unknown keys are skipped, null and missing values are stored as 0 and flagged in NullBits and MissingBits.
+// djReadColumns appends to the columns, djResetColumns clears them but keeps the memory.
+//
+// Seeking directly to a value, skipped members and elements aren't unescaped or converted
+//   if (djReadSeekPath(Context, "/meta/shards/3")) {
+//     dj_s64 Shard = djReadS64(Context);
+//   }
+// Returns 1 if the value is found and the context is positioned to read it with any djRead method, it's still 
+// inside the containers of the path so those can be continued to be read. Returns 0 if the path doesn't exist, the
+// context is then positioned after the object/array that was missing the member, or at the value that wasn't a
+// container. '~0' and '~1' in the path are unescaped to '~' and '/'.
+//
+// Indexing huge array files, the offsets of the elements are found once and saved next to the file
+//   dj_read_context* Context = djReadOpenAndReadFile("events.json");
+//   dj_array_index* Index = djBuildArrayIndex(Context, 64); // The offset of every 64:th element is stored
+//   djSaveArrayIndex(Index, "events.json.idx");
+// Later the index is loaded and a context is opened at any element, only the part of the file that is needed 
+// is read.
+//   dj_array_index* Index = djLoadArrayIndex("events.json.idx"); // Returns 0 if the file isn't an index
+//   dj_read_context* Context = djReadFromArrayIndex("events.json", Index, 1000000);
+//   while (djReadArray(Context)) { // Element 1000000 comes first, returns 0 at the next indexed element
+//     ...
+//   }
+// The elements before Element in its stride are skipped, so the stride trades index size for skipping. The file
+// can't change after the index is built.
+//
+// Random access, when values needs to be read out of order a tape can be built for the next value.
+//   dj_tape* Tape = djReadTape(Context); // Reads the next value, returns 0 if an error occurs
+//   size_t Shard = djTapeFindKey(Tape, 1, "shard");
+//   if (djTapeType(Tape, Shard) == djTYPE_S64) 
+//     djTapeS64(Tape, Shard);
+//   djDestroyTape(Tape);
+// The tape is a flat array of 64 bit entries where containers store the index of the entry after their end, so 
+// djTapeNext (the next sibling) is O(1). djTapeChild returns the first member, for objects the members alternate
+// between key and value. Strings without escape sequences points directly into the json data (so they are NOT
+// null terminated) and the tape can only be used while the context is alive. Only the subtree of the next value
+// is stored, use the normal djRead functions to get to the part of the document that's interesting. A container
+// can have at most 16777215 members and a tape at most 4294967295 entries, larger values are reported as errors.
+//
+// Projection, when the same few values are extracted from many documents the paths can be compiled once.
+//   const char* Paths[] = { "/id", "/user/name", "/tags/0" };
+//   dj_projection* Projection = djInitializeProjection(Paths, 3);
+//   dj_projection_slot Slots[3];
+//   while (djReadNextDocument(Context)) {
+//     djReadProjection(Context, Projection, Slots); // Returns the number of paths found
+//     if (Slots[1].Type == djTYPE_STRING) 
+//       puts(Slots[1].String.Data);
+//   }
+//   djDestroyProjection(Projection);
+// All paths are extracted in a single pass, everything else is skipped without being unescaped or converted and
+// the rest of the document is skipped as soon as every path is found. Objects and arrays at a path only sets the
+// type of the slot. Strings are null terminated and stay valid until the next call to djReadProjection.
+//
+// Push parsing, when the input arrives in pieces (e.g. from a non-blocking socket) it can be fed as it comes.
+//   dj_push_callbacks Callbacks = { 0 };
+//   Callbacks.Key = OnKey; // void OnKey(dj_read_context* Context, void* Ptr, dj_string Key)
+//   dj_read_context* Context = djReadPush(&Callbacks, Ptr);
+//   while ((Length = recv(Socket, Data, sizeof(Data), 0)) > 0)
+//     djReadFeed(Context, Data, Length); // Returns 0 if an error has occured
+//   djReadFeedEnd(Context);
+// The callbacks are called as soon as each value is complete, only a token (string, number, true/false/null) 
+// that is split between two feeds is copied. Concatenated values, like JSON Lines, are read one after another
+// and EndDocument is called after each. A number at the very end is only complete once more data or
+// djReadFeedEnd arrives. Errors show an excerpt of the data given to djReadFeed, so the line and column are
+// relative to it. A callback can stop the parsing by reporting an error with djReadReportErrorIfNoErrorExists.
+// A gzip file can be fed a block at a time, so only one block of DIR_JSON_GZIP_BLOCK_SIZE bytes is in RAM.
+//   djReadFeedGzipFile(Context, FilePath); // Feeds the whole file and calls djReadFeedEnd, returns 0 on errors
 // 
 // WRITING
 //
 // TODO: Write documentation
 //
+// Binary formats
+//   djWriteSetFormat(Context, djFORMAT_MSGPACK) // Or djFORMAT_CBOR, djFORMAT_JSON is the default
+// Needs to be called directly after the context is created, the same djWrite calls then emits MessagePack or CBOR.
+// Pretty printing is ignored and djWriteFinalize doesn't append a null terminator for binary formats. 
+// MessagePack containers are kept in the buffer until the outermost container is closed, since their member count
+// is written in front of the members. CBOR uses indefinite length containers and is streamed directly.
+//
+// Writing into a buffer owned by the caller, nothing but the context is allocated
+//   char Packet[1500];
+//   dj_write_context* Context = djWriteInitializeContextTargetBuffer(Packet, sizeof(Packet));
+//   ...
+//   if (!djWriteFinalize(Context)) // Returns Packet, or 0 if it was too small
+//     Size = djWriteRequiredSize(Context); // Retry with a buffer of this size
+// Once the buffer is full the rest of the output is only counted, like snprintf. djWriteRequiredSize includes the
+// null terminator for json. For MessagePack it includes 4 bytes of room that an open container needs.
+//
+// Reusing a context, the buffer keeps the size it has grown to so the steady state doesn't allocate
+//   dj_write_context* Context = djWriteInitializeContextTargetString(0);
+//   for (each response) {
+//     djWriteReset(Context); // Throws away anything written and any error
+//     ...
+//     size_t Length;
+//     const char* Json = djWriteFinalizeWithLength(Context, &Length); // Owned by the context, no strlen needed
+//   }
+// Format and pretty printing are kept by djWriteReset. File targets can't be reset.
+//
+// Writing into segments, large output is never copied when the buffer is full
+//   dj_write_context* Context = djWriteInitializeContextTargetSegments(64 * 1024);
+//   ...
+//   djWriteFinalize(Context); // Returns 0, the output is in the segments
+//   int Count;
+//   const dj_segment* Segments = djWriteGetSegments(Context, &Count);
+//   writev(Socket, (const struct iovec*)Segments, Count);
+// Each time a segment is full a new one is started, djWriteJoinSegments copies them into one string if needed.
+// There is no null terminator. MessagePack containers grow the current segment until the outermost is closed.
+//
+// Compressed output, define DIR_JSON_ZLIB and link with zlib
+//   djWriteInitializeContextTargetGzipFilePath(FilePath, BufferSize, Level) // Level 0-9, -1 for zlib's default
+// Each time the buffer is full it's compressed and written, so only BufferSize bytes are kept in memory.
+//
+// Memory mapped output, define DIR_JSON_MMAP on POSIX systems
+//   djWriteInitializeContextTargetMappedFilePath(FilePath, WindowSize) // 0 for the default of 64MB
+// The output is written directly into a mapped window of the file, without going through stdio. When the window is
+// full the file is grown with ftruncate and the next window is mapped. djWriteFinalize truncates the file to the
+// size that was written. An open MessagePack container grows the window instead, like it grows the buffer.
+//
+// Copying values from a read context, e.g. to pass through the members that aren't changed
+//   while (djReadKey(Source, &Key)) {
+//     if (strcmp(Key.Data, "password") == 0) {
+//       djReadSkipValue(Source);
+//     } else {
+//       djWriteKey(Output, Key.Data);
+//       djCopyValue(Source, Output);
+//     }
+//   }
+// When both contexts are json the value isn't unescaped or converted, the bytes are copied with only the whitespace
+// changed to match the pretty printing of Output. Other formats are read and written value by value.
+//
+// Applying a JSON Merge Patch (RFC 7386) while copying a document, without building a tree of the document
+//   dj_read_context* PatchContext = djReadFromString("{ \"name\": \"new\", \"obsolete\": null }");
+//   dj_tape* Patch = djReadTape(PatchContext);
+//   djMergePatch(Source, Patch, Output); // Reads the next value of Source and writes it patched to Output
+// Members that the patch doesn't touch are copied with djCopyValue. The patch (and its context) needs to stay alive
+// during the call, it can be applied to any number of documents. Numbers from a json patch are written to json
+// output exactly as they are in the patch.
+//
+// STATISTICS
+//
+// Define DIR_JSON_STATS to count where the time goes, e.g. whitespace skipped, escapes decoded, slow numbers and 
+// hash probes when reading and flushes and reallocations when writing. Without it the counters cost nothing.
+//   dj_read_stats  ReadStats  = djReadGetStats(Context);
+//   dj_write_stats WriteStats = djWriteGetStats(Context);
+//
+// Define DIR_JSON_PROFILE to measure which members are expensive to read. The time and bytes between reading a key
+// (or array element) and the next one is attributed to the key path, array elements are merged into '*'.
+//   djReadProfileReport(Context, stdout, 20); // Prints the 20 paths with the most time spent in the path itself
+// The time is measured with DIR_JSON_PROFILE_CLOCK() which defaults to nanoseconds from timespec_get, it can be
+// defined to e.g. __rdtsc() to count cycles instead.
+//
 
 #ifndef DIR_JSON_H
 #define DIR_JSON_H
@@ -81,6 +277,11 @@
 typedef struct dj_read_context dj_read_context;
 typedef struct dj_write_context dj_write_context;
 typedef struct dj_callbacks_object dj_callbacks_object;
+typedef struct dj_key_dictionary dj_key_dictionary;
+typedef struct dj_columns_object dj_columns_object;
+typedef struct dj_tape dj_tape;
+typedef struct dj_projection dj_projection;
+typedef struct dj_array_index dj_array_index;
 
 // ===============================================================================
 // Data Types
@@ -93,6 +294,52 @@ typedef struct {
   const char* Data;
 } dj_string;
 
+#define djFORMAT_JSON    0
+#define djFORMAT_MSGPACK 1
+#define djFORMAT_CBOR    2
+
+#define djNUMBER_INTEGER  0
+#define djNUMBER_FRACTION 1
+#define djNUMBER_EXPONENT 2
+
+typedef struct {
+  dj_string Text; // The number as written, not null terminated
+  int Flags;      // djNUMBER_INTEGER or djNUMBER_FRACTION and/or djNUMBER_EXPONENT
+  int Digits;     // Significant digits before the exponent, leading zeros aren't counted
+  int IsNegative;
+} dj_number;
+
+
+// ===============================================================================
+// Statistics
+// ===============================================================================
+
+// Except for BytesScanned the counters are only collected if DIR_JSON_STATS is defined, otherwise they are 0.
+typedef struct {
+  size_t BytesScanned;        // Bytes of the input consumed so far
+  size_t WhitespaceSkipped;
+  size_t StringsRead;
+  size_t EscapesDecoded;
+  size_t StringBufferGrowths;
+  size_t NumbersFast;         // Integers without an exponent
+  size_t NumbersSlow;         // Integers with an exponent and all numbers parsed with strtod
+  size_t CallbackDispatches;  // Member and unknown key callbacks called by djReadObjectUsingCallbacks
+  size_t HashProbes;          // Slots compared when looking up keys in callback objects and columns
+} dj_read_stats;
+
+typedef struct {
+  size_t BytesWritten;        // Bytes produced so far, including what's still in the buffer
+  size_t Flushes;             // Times the buffer was handed to the file or callback
+  size_t BufferReallocs;
+} dj_write_stats;
+
+DIR_JSON_EXTERN dj_read_stats  djReadGetStats( dj_read_context*  Context);
+DIR_JSON_EXTERN dj_write_stats djWriteGetStats(dj_write_context* Context);
+
+#ifdef DIR_JSON_PROFILE
+DIR_JSON_EXTERN void djReadProfileReport(dj_read_context* Context, FILE* File, int TopCount);
+#endif
+
 
 // ===============================================================================
 // Object Callbacks
@@ -113,6 +360,146 @@ typedef struct {
 DIR_JSON_EXTERN dj_callbacks_object* djInitializeObject(dj_member* Members, int MemberCount, dj_key_callback UnknownKeyCallback);
 DIR_JSON_EXTERN void djDestroyObject(dj_callbacks_object* Object);
 
+
+// ===============================================================================
+// Key Dictionary
+// ===============================================================================
+
+DIR_JSON_EXTERN dj_key_dictionary* djInitializeKeyDictionary(const char** Keys, int KeyCount);
+DIR_JSON_EXTERN void               djDestroyKeyDictionary(dj_key_dictionary* Dictionary);
+
+
+// ===============================================================================
+// Columns
+// ===============================================================================
+
+#define djCOLUMN_S64    0
+#define djCOLUMN_F64    1
+#define djCOLUMN_BOOL   2
+#define djCOLUMN_STRING 3
+
+typedef struct {
+  const char* Key;
+  int Type;
+} dj_column_member;
+
+typedef struct {
+  int Type;
+  size_t Count;               // Number of rows in the column
+  void* Values;               // dj_s64*, dj_f64*, char* (bools) or size_t* (string offsets, Count + 1 entries)
+  char* StringData;           // String columns only, the strings are stored back to back without terminators
+  unsigned char* NullBits;    // Bit N is set if the value of row N was null
+  unsigned char* MissingBits; // Bit N is set if the object of row N didn't contain the key
+} dj_column;
+
+DIR_JSON_EXTERN dj_columns_object* djInitializeColumns(dj_column_member* Members, int MemberCount);
+DIR_JSON_EXTERN void djDestroyColumns(dj_columns_object* Columns);
+DIR_JSON_EXTERN void djResetColumns(  dj_columns_object* Columns);
+
+DIR_JSON_EXTERN const dj_column* djGetColumn(dj_columns_object* Columns, int ColumnIndex);
+DIR_JSON_EXTERN size_t djReadColumns(dj_read_context* Context, dj_columns_object* Columns);
+
+
+// ===============================================================================
+// Tape
+// ===============================================================================
+
+#define djTYPE_NONE   0
+#define djTYPE_OBJECT 1
+#define djTYPE_ARRAY  2
+#define djTYPE_STRING 3
+#define djTYPE_S64    4
+#define djTYPE_F64    5
+#define djTYPE_BOOL   6
+#define djTYPE_NULL   7
+
+DIR_JSON_EXTERN dj_tape* djReadTape(dj_read_context* Context);
+DIR_JSON_EXTERN void     djDestroyTape(dj_tape* Tape);
+
+// The root value of a tape has index 1, an index of 0 means that there is no value.
+DIR_JSON_EXTERN int       djTapeType(   dj_tape* Tape, size_t Index);
+DIR_JSON_EXTERN size_t    djTapeNext(   dj_tape* Tape, size_t Index);
+DIR_JSON_EXTERN size_t    djTapeChild(  dj_tape* Tape, size_t Index);
+DIR_JSON_EXTERN size_t    djTapeCount(  dj_tape* Tape, size_t Index);
+DIR_JSON_EXTERN size_t    djTapeFindKey(dj_tape* Tape, size_t ObjectIndex, const char* Key);
+DIR_JSON_EXTERN size_t    djTapeElement(dj_tape* Tape, size_t ArrayIndex, size_t ElementIndex);
+DIR_JSON_EXTERN int       djTapeBool(   dj_tape* Tape, size_t Index);
+DIR_JSON_EXTERN dj_s64    djTapeS64(    dj_tape* Tape, size_t Index);
+DIR_JSON_EXTERN dj_f64    djTapeF64(    dj_tape* Tape, size_t Index);
+DIR_JSON_EXTERN dj_string djTapeString( dj_tape* Tape, size_t Index);
+
+// ===============================================================================
+// Projection
+// ===============================================================================
+
+typedef struct {
+  int Type; // djTYPE_NONE if the path wasn't found
+  int Bool;
+  dj_s64 S64;
+  dj_f64 F64; // Numbers are stored both as S64 and F64, S64 is 0 if the value is outside of its range
+  dj_string String;
+} dj_projection_slot;
+
+DIR_JSON_EXTERN dj_projection* djInitializeProjection(const char** Paths, int PathCount);
+DIR_JSON_EXTERN void           djDestroyProjection(dj_projection* Projection);
+
+// Reads the next value and stores the value at Paths[i] in Slots[i]. Returns the number of paths found.
+DIR_JSON_EXTERN int djReadProjection(dj_read_context* Context, dj_projection* Projection, dj_projection_slot* Slots);
+
+// Prepares for reading the next value in a stream of concatenated values, like JSON Lines or back to back 
+// MessagePack documents. Returns 0 when the end of the data is reached or if an error exists.
+DIR_JSON_EXTERN int djReadNextDocument(dj_read_context* Context);
+
+// ===============================================================================
+// Array Index
+// ===============================================================================
+
+// Reads the next value, which needs to be an array, and stores the offset of every Stride:th element.
+DIR_JSON_EXTERN dj_array_index* djBuildArrayIndex(dj_read_context* Context, int Stride);
+DIR_JSON_EXTERN int             djSaveArrayIndex(dj_array_index* Index, const char* FilePath);
+DIR_JSON_EXTERN dj_array_index* djLoadArrayIndex(const char* FilePath);
+DIR_JSON_EXTERN void            djDestroyArrayIndex(dj_array_index* Index);
+DIR_JSON_EXTERN dj_s64          djArrayIndexCount(dj_array_index* Index);
+
+// Reads the elements from Element to the next indexed element out of the file the index was built from.
+DIR_JSON_EXTERN dj_read_context* djReadFromArrayIndex(const char* FilePath, dj_array_index* Index, dj_s64 Element);
+
+// ===============================================================================
+// Push Parser
+// ===============================================================================
+
+// Called as the values are parsed, any of them can be 0. Strings and keys are null terminated and only valid
+// during the call. The callbacks may not call any djRead functions except djReadError.
+typedef struct {
+  void (*StartObject)(dj_read_context* Context, void* Ptr);
+  void (*EndObject)(  dj_read_context* Context, void* Ptr);
+  void (*StartArray)( dj_read_context* Context, void* Ptr);
+  void (*EndArray)(   dj_read_context* Context, void* Ptr);
+  void (*Key)(        dj_read_context* Context, void* Ptr, dj_string Key);
+  void (*String)(     dj_read_context* Context, void* Ptr, dj_string Value);
+  void (*S64)(        dj_read_context* Context, void* Ptr, dj_s64 Value);
+  void (*F64)(        dj_read_context* Context, void* Ptr, dj_f64 Value);
+  void (*Bool)(       dj_read_context* Context, void* Ptr, int Value);
+  void (*Null)(       dj_read_context* Context, void* Ptr);
+  void (*EndDocument)(dj_read_context* Context, void* Ptr); // After each complete top level value
+} dj_push_callbacks;
+
+DIR_JSON_EXTERN dj_read_context* djReadPush(const dj_push_callbacks* Callbacks, void* Ptr);
+
+// Parses the next part of the input, it can end anywhere, even in the middle of a string or number. Returns 0 if
+// an error exists. The data doesn't need to be kept alive after the call.
+DIR_JSON_EXTERN int djReadFeed(dj_read_context* Context, const char* Data, size_t Length);
+
+// Tells the parser that there is no more input, finishes a number at the end and checks that no value is left 
+// open. Returns 0 if an error exists.
+DIR_JSON_EXTERN int djReadFeedEnd(dj_read_context* Context);
+
+#ifdef DIR_JSON_ZLIB
+// Decompresses the file a block at a time and feeds each block, followed by djReadFeedEnd. Returns 0 if an error
+// exists.
+DIR_JSON_EXTERN int djReadFeedGzipFile(dj_read_context* Context, const char* FilePath);
+#endif
+
 // ===============================================================================
 // Reading
 // ===============================================================================
@@ -120,6 +507,11 @@ DIR_JSON_EXTERN void djDestroyObject(dj_callbacks_object* Object);
 DIR_JSON_EXTERN dj_read_context* djReadReadFile(FILE* File);
 DIR_JSON_EXTERN dj_read_context* djReadOpenAndReadFile(const char* FilePath);
 DIR_JSON_EXTERN dj_read_context* djReadFromString(const char* JsonString);
+DIR_JSON_EXTERN dj_read_context* djReadFromBuffer(const char* Data, size_t Length);
+DIR_JSON_EXTERN dj_read_context* djReadFromBinary(const void* Data, size_t Length, int Format);
+#ifdef DIR_JSON_ZLIB
+DIR_JSON_EXTERN dj_read_context* djReadOpenAndReadGzipFile(const char* FilePath);
+#endif
 DIR_JSON_EXTERN void djReadDestroyContext(dj_read_context* Context);
 
 DIR_JSON_EXTERN void djReadReportErrorIfNoErrorExists(dj_read_context* Context, const char* Start, const char* OnePastLast,
@@ -132,14 +524,31 @@ DIR_JSON_EXTERN int       djReadOptionalKey( dj_read_context* Context, const cha
 DIR_JSON_EXTERN int       djReadMandatoryKey(dj_read_context* Context, const char* Key);
 DIR_JSON_EXTERN int       djReadObjectEnd(   dj_read_context* Context);
 
+DIR_JSON_EXTERN void      djReadSetKeyDictionary(dj_read_context* Context, dj_key_dictionary* Dictionary);
+DIR_JSON_EXTERN int       djReadKeyId(         dj_read_context* Context, int* IdOut);
+DIR_JSON_EXTERN int       djReadOptionalKeyId( dj_read_context* Context, int Id);
+DIR_JSON_EXTERN int       djReadMandatoryKeyId(dj_read_context* Context, int Id);
+
 DIR_JSON_EXTERN int       djReadArray( dj_read_context* Context);
 DIR_JSON_EXTERN int       djReadBool(  dj_read_context* Context);
 DIR_JSON_EXTERN dj_s64    djReadS64(   dj_read_context* Context);
 DIR_JSON_EXTERN dj_f64    djReadF64(   dj_read_context* Context);
+DIR_JSON_EXTERN dj_s64    djReadDecimal(dj_read_context* Context, int Scale);
+DIR_JSON_EXTERN dj_number djReadNumberRaw(dj_read_context* Context);
 DIR_JSON_EXTERN dj_string djReadString(dj_read_context* Context);
 DIR_JSON_EXTERN void      djReadNull(  dj_read_context* Context);
 DIR_JSON_EXTERN void      djReadEOF(   dj_read_context* Context);
 
+// Skips the next value, whatever type it is. Only the structure is checked, the content isn't validated.
+DIR_JSON_EXTERN void      djReadSkipValue(dj_read_context* Context);
+
+// Checks that Data is a single well formed json value with valid UTF-8, the data doesn't need to be null terminated.
+// Returns 1 if valid, otherwise 0 and ErrorOffset (if not null) is set to the offset of the first invalid byte.
+DIR_JSON_EXTERN int       djValidate(const char* Data, size_t Length, size_t* ErrorOffset);
+
+// Moves to the value at the JSON Pointer (RFC 6901) Path, e.g. "/meta/routing/shard", relative to the next value.
+DIR_JSON_EXTERN int       djReadSeekPath(dj_read_context* Context, const char* Path);
+
 // Returns true if the next value is of the respective type.
 // Doesn't check that the value is legally formatted. For example djReadNextIsNull will return 1 for noll.
 DIR_JSON_EXTERN int djReadNextIsObject(dj_read_context* Context);
@@ -156,14 +565,42 @@ DIR_JSON_EXTERN int djReadNextIsNull(  dj_read_context* Context);
 
 typedef void(*dj_write_callback)(dj_write_context*, char* Data, int Size);
 
+// Has the same layout as struct iovec on POSIX systems, so the segments can be passed directly to writev/sendmsg.
+typedef struct {
+  void* Data;
+  size_t Length;
+} dj_segment;
+
 DIR_JSON_EXTERN dj_write_context* djWriteInitializeContextTargetString(int StartBufferSize);
 DIR_JSON_EXTERN dj_write_context* djWriteInitializeContextTargetFile(FILE* File, int BufferSize);
 DIR_JSON_EXTERN dj_write_context* djWriteInitializeContextTargetFilePath(const char* FilePath, int BufferSize);
 DIR_JSON_EXTERN dj_write_context* djWriteInitializeContextTargetCustom(dj_write_callback Callback, int BufferSize);
+DIR_JSON_EXTERN dj_write_context* djWriteInitializeContextTargetBuffer(char* Buffer, int Size);
+DIR_JSON_EXTERN dj_write_context* djWriteInitializeContextTargetSegments(int SegmentSize);
+#ifdef DIR_JSON_ZLIB
+DIR_JSON_EXTERN dj_write_context* djWriteInitializeContextTargetGzipFilePath(const char* FilePath, int BufferSize, 
+                                                                             int Level);
+#endif
+#ifdef DIR_JSON_MMAP
+DIR_JSON_EXTERN dj_write_context* djWriteInitializeContextTargetMappedFilePath(const char* FilePath, int WindowSize);
+#endif
 
 DIR_JSON_EXTERN void djWriteSetPrettyPrint(dj_write_context* Context, int ShouldPrettyPrint);
+DIR_JSON_EXTERN void djWriteSetFormat(     dj_write_context* Context, int Format);
 
 DIR_JSON_EXTERN char* djWriteFinalize(      dj_write_context* Context);
+DIR_JSON_EXTERN dj_s64 djWriteRequiredSize( dj_write_context* Context);
+DIR_JSON_EXTERN void  djWriteReset(         dj_write_context* Context);
+
+// Same as djWriteFinalize but the string stays owned by the context, it's valid until djWriteReset or 
+// djWriteDestroyContext. LengthOut (if not null) is set to the length of the whole output, excluding the null 
+// terminator, for all targets.
+DIR_JSON_EXTERN const char* djWriteFinalizeWithLength(dj_write_context* Context, size_t* LengthOut);
+
+// The output of the segments target, valid after djWriteFinalize until djWriteReset or djWriteDestroyContext.
+DIR_JSON_EXTERN const dj_segment* djWriteGetSegments(dj_write_context* Context, int* CountOut);
+// Copies the segments into a single null terminated string that the caller needs to free.
+DIR_JSON_EXTERN char* djWriteJoinSegments(dj_write_context* Context, size_t* LengthOut);
 DIR_JSON_EXTERN void  djWriteDestroyContext(dj_write_context* Context);
 
 DIR_JSON_EXTERN void djWriteStartObject(dj_write_context* Context);
@@ -174,9 +611,20 @@ DIR_JSON_EXTERN void djWriteEndArray(   dj_write_context* Context);
 DIR_JSON_EXTERN void djWriteBool(       dj_write_context* Context, int Value);
 DIR_JSON_EXTERN void djWriteS64(        dj_write_context* Context, dj_s64 Value);
 DIR_JSON_EXTERN void djWriteF64(        dj_write_context* Context, dj_f64 Value);
+// Writes Value / 10^Scale with exactly Scale decimals, djWriteDecimal(Context, 1250, 2) writes 12.50
+DIR_JSON_EXTERN void djWriteDecimal(    dj_write_context* Context, dj_s64 Value, int Scale);
 DIR_JSON_EXTERN void djWriteString(     dj_write_context* Context, const char* Str);
 DIR_JSON_EXTERN void djWriteNull(       dj_write_context* Context);
 
+// ===============================================================================
+// Copying
+// ===============================================================================
+
+// Reads the next value of Source and writes it to Output. Returns 0 if an error occured.
+DIR_JSON_EXTERN int djCopyValue(dj_read_context* Source, dj_write_context* Output);
+// Reads the next value of Source, applies the patch to it and writes the result. Returns 0 if an error occured.
+DIR_JSON_EXTERN int djMergePatch(dj_read_context* Source, dj_tape* Patch, dj_write_context* Output);
+
 
 // ===============================================================================
 // Implementation
@@ -203,6 +651,22 @@ DIR_JSON_EXTERN void djWriteNull(       dj_write_context* Context);
 #define DIR_JSON_WRITE_INDENTION_SPACE_COUNT 4
 #endif
 
+#ifndef DIR_JSON_READ_MAX_DEPTH
+#define DIR_JSON_READ_MAX_DEPTH 64
+#endif
+
+#ifndef DIR_JSON_WRITE_MAX_DEPTH
+#define DIR_JSON_WRITE_MAX_DEPTH 64
+#endif
+
+#ifndef DIR_JSON_VALIDATE_MAX_DEPTH
+#define DIR_JSON_VALIDATE_MAX_DEPTH 1024
+#endif
+
+#ifndef DIR_JSON_GZIP_BLOCK_SIZE
+#define DIR_JSON_GZIP_BLOCK_SIZE (64 * 1024)
+#endif
+
 
 // ===============================================================================
 // Includes
@@ -213,6 +677,58 @@ DIR_JSON_EXTERN void djWriteNull(       dj_write_context* Context);
 #include <assert.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <limits.h>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
+
+#ifdef DIR_JSON_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef DIR_JSON_MMAP
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if !defined(DIR_JSON_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64))
+#define _DJ_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#ifdef DIR_JSON_PROFILE
+#ifndef DIR_JSON_PROFILE_CLOCK
+#include <time.h>
+static dj_s64 _djProfileClock() {
+  struct timespec Time;
+  timespec_get(&Time, TIME_UTC);
+  return (dj_s64)Time.tv_sec * 1000000000 + Time.tv_nsec;
+}
+#define DIR_JSON_PROFILE_CLOCK() _djProfileClock()
+#endif
+
+#define _DJ_PROFILE_ENTER(Context)       _djProfileEnter(Context)
+#define _DJ_PROFILE_MEMBER(Context, Key) _djProfileMember(Context, Key)
+#define _DJ_PROFILE_EXIT(Context)        _djProfileExit(Context)
+#else
+#define _DJ_PROFILE_ENTER(Context)       ((void)0)
+#define _DJ_PROFILE_MEMBER(Context, Key) ((void)0)
+#define _DJ_PROFILE_EXIT(Context)        ((void)0)
+#endif
+
+#ifdef DIR_JSON_STATS
+#define _DJ_STAT_ADD(Context, Counter, Amount) ((Context)->Stats.Counter += (Amount))
+#define _DJ_STAT_PTR(Context, Counter) (&(Context)->Stats.Counter)
+#else
+#define _DJ_STAT_ADD(Context, Counter, Amount) ((void)0)
+#define _DJ_STAT_PTR(Context, Counter) ((size_t*)0)
+#endif
 
 
 // ===============================================================================
@@ -226,37 +742,156 @@ struct dj_callbacks_object {
   int* MemberKeys;
 };
 
+struct dj_key_dictionary {
+  int SlotsCount, KeyCount;
+  int* SlotKeys;   // Offset of the key from the dictionary, 0 if the slot is empty
+  int* SlotIds;
+  int* KeyOffsets; // Offset of each key by ID, for the error messages
+};
+
+typedef struct {
+  dj_column Public;
+  size_t StringDataSize;
+} _dj_column;
+
+struct dj_columns_object {
+  int SlotsCount, ColumnCount;
+  int* ColumnKeys;
+  int* SlotColumns;
+  size_t RowCount, RowCapacity;
+  _dj_column* Columns;
+};
+
+typedef struct {
+  dj_s64 Remaining; // Members left to read, -1 for CBOR indefinite length containers
+  int IsObject;
+} _dj_read_container;
+
+#ifdef DIR_JSON_PROFILE
+// A node for each key path that has been read, node 0 is the root.
+typedef struct {
+  int Parent, FirstChild, NextSibling;
+  dj_string Key; // Owned copy, "*" for array elements
+  dj_s64 Ticks;  // Including the children
+  size_t Bytes;
+  size_t Count;
+} _dj_profile_node;
+
+typedef struct {
+  int ParentNode;
+  int MemberNode; // -1 until the first member is read
+  dj_s64 StartTicks;
+  const char* StartChar;
+} _dj_profile_level;
+
+typedef struct {
+  _dj_profile_node* Nodes;
+  int NodeCount, NodeCapacity;
+  int Depth;
+  _dj_profile_level Levels[DIR_JSON_READ_MAX_DEPTH];
+} _dj_profile;
+#endif
+
+typedef struct {
+  dj_push_callbacks Callbacks;
+  void* Ptr;
+  int State;          // What is expected next, _dj_Push_Value etc.
+  int Token;          // The token the last feed ended in the middle of, _dj_Push_Token_None if none
+  int TokenIsKey;
+  int InEscape;       // The last feed ended directly after a backslash in a string
+  char* TokenData;    // The part of the token that was in earlier feeds
+  size_t TokenLength, TokenSize;
+} _dj_push;
+
 struct dj_read_context {
   char* JsonDataOwnagePtr;
   const char* JsonData;
   const char* CurrentChar;
+  const char* EndOfData;
+  
+  int Format;
+  int ContainerDepth; // NOTE: Only used by the binary formats and the push parser
+  _dj_read_container Containers[DIR_JSON_READ_MAX_DEPTH];
+  
+  _dj_push Push; // NOTE: Only used by contexts from djReadPush
   
-  const char* StartOfCurrentLine;
-  int LineNumber;
   int ShouldReadValueNext; // NOTE: If false a ',', '}', ']' or EOF should be read. Else a value.
   
   dj_string CachedKey;
+  dj_key_dictionary* KeyDictionary;
   
   const char* Error;
   
   int StringBufferSize;
   char* StringBuffer;
+  
+  size_t BytesScannedBefore; // Bytes consumed from data that JsonData no longer points to, see djReadGetStats
+  
+#ifdef DIR_JSON_STATS
+  dj_read_stats Stats;
+#endif
+#ifdef DIR_JSON_PROFILE
+  _dj_profile Profile;
+#endif
 };
 
+typedef struct {
+  int Offset;
+  int Count;
+  int IsObject;
+} _dj_write_container;
+
 struct dj_write_context {
   int ShouldCloseFile;
   FILE* TargetFile;
+#ifdef DIR_JSON_ZLIB
+  gzFile TargetGzipFile;
+#endif
   dj_write_callback Callback;
   
   const char* Error;
   
+  int Format;
   int PrettyPrint;
   int IsRootValue;
   int Indention;
   int ContextClue;
   
+  // NOTE: Only used by MessagePack where the member count of a container is written before its members.
+  int ContainerDepth;
+  _dj_write_container Containers[DIR_JSON_WRITE_MAX_DEPTH];
+  int IgnoredContainerDepth; // Containers started after DIR_JSON_WRITE_MAX_DEPTH was reached
+  
   int Used, Size;
   char* Buffer;
+  dj_s64 Flushed; // Bytes handed to the file or callback
+  
+  // NOTE: Only used by djWriteInitializeContextTargetBuffer, when the callers buffer is full the rest of the output 
+  // is written to Scratch and only counted.
+  char* FixedBuffer;
+  int FixedSize, FixedUsed;
+  dj_s64 Overflow;
+  char Scratch[64];
+  
+  // NOTE: Only used by djWriteInitializeContextTargetSegments, each full buffer becomes a segment.
+  int IsSegmented;
+  dj_segment* Segments;
+  int SegmentCount, SegmentCapacity;
+  
+#ifdef DIR_JSON_MMAP
+  // NOTE: Only used by djWriteInitializeContextTargetMappedFilePath, the buffer points into a window of the file 
+  // starting at Flushed. The mapping itself starts at the page before.
+  int IsMappedFile;
+  int MappedFile;
+  char* MapBase;
+  size_t MapSize;
+  int WindowSize;
+  dj_s64 PageSize;
+#endif
+  
+#ifdef DIR_JSON_STATS
+  dj_write_stats Stats;
+#endif
 };
 
 
@@ -274,21 +909,63 @@ static unsigned int _djHashString(const char* String) {
   return Hash;
 }
 
+// Same hash as _djHashString, for strings that aren't null terminated.
+static unsigned int _djHashStringN(const char* String, size_t Length) {
+  unsigned int Hash = 5381;
+  
+  for (size_t Index = 0; Index < Length; Index++)
+    Hash = ((Hash << 5) + Hash) + String[Index];
+  
+  return Hash;
+}
+
+static int _djStringEquals(dj_string String, const char* Other) {
+  return strncmp(String.Data, Other, String.Length) == 0 && Other[String.Length] == '\0';
+}
+
+static int _djStringEqualsN(dj_string String, dj_string Other) {
+  return String.Length == Other.Length && memcmp(String.Data, Other.Data, String.Length) == 0;
+}
+
 // ===============================================================================
 // Object Callbacks Implementation
 // ===============================================================================
 
 const int _dj_Mandatory_Flag = (1 << 31);
 
+// Looks up Key in an open addressed table where each slot holds the offset (from Base) of a null terminated key, 
+// or 0 if the slot is empty. The mandatory flag is ignored. Returns the slot index or -1 if the key isn't found.
+// Probes is incremented for each slot compared, it's null when the statistics are disabled.
+static int _djFindSlot(const char* Base, const int* SlotKeys, int SlotsCount, dj_string Key, size_t* Probes) {
+  unsigned int SlotIndex = _djHashStringN(Key.Data, Key.Length) % SlotsCount;
+  
+  while (SlotKeys[SlotIndex]) {
+    if (Probes)
+      *Probes += 1;
+    const char* SlotKey = Base + (SlotKeys[SlotIndex] & ~_dj_Mandatory_Flag);
+    if (_djStringEquals(Key, SlotKey)) {
+      return (int)SlotIndex;
+    }
+    SlotIndex = (SlotIndex + 1) % SlotsCount;
+  }
+  
+  return -1;
+}
+
 static void ReportUnkownMemberCallback(dj_read_context* Context, void* Ptr, dj_string Key) {
-  const char* KeyEndPtr = Context->CurrentChar - 1;
-  while (*KeyEndPtr   != '"') --KeyEndPtr;
-  const char* KeyStartPtr = KeyEndPtr - 1;
-  while (*KeyStartPtr != '"') --KeyStartPtr;
+  const char* KeyStartPtr = 0;
+  const char* KeyEndPtr   = 0;
+  if (Context->Format == djFORMAT_JSON) {
+    KeyEndPtr = Context->CurrentChar - 1;
+    while (*KeyEndPtr   != '"') --KeyEndPtr;
+    KeyStartPtr = KeyEndPtr - 1;
+    while (*KeyStartPtr != '"') --KeyStartPtr;
+  }
   
   char* KeyCopy = malloc(Key.Length + 1);
-  memcpy(KeyCopy, Key.Data, Key.Length + 1);
-  djReadReportErrorIfNoErrorExists(Context, KeyStartPtr, KeyEndPtr + 1,
+  memcpy(KeyCopy, Key.Data, Key.Length);
+  KeyCopy[Key.Length] = '\0';
+  djReadReportErrorIfNoErrorExists(Context, KeyStartPtr, KeyEndPtr + (KeyEndPtr != 0),
                                    "Unkown member encountered (Key '%s'. )", KeyCopy);
   free(KeyCopy);
 }
@@ -355,77 +1032,383 @@ void djDestroyObject(dj_callbacks_object* Object) {
   free(Object);
 }
 
-
 // ===============================================================================
-// Read Implementation
+// Key Dictionary Implementation
 // ===============================================================================
 
-static void _djEatWhiteSpaces(dj_read_context* Context) {
-  const char* CurrentChar = Context->CurrentChar;
-  char Char;
-  while (Char = *CurrentChar) {
-    if (Char == '\n') {
-      Context->LineNumber += 1;
-    } else if (Char != '\r' && Char != '\t' && Char != ' ') {
-      break;
+dj_key_dictionary* djInitializeKeyDictionary(const char** Keys, int KeyCount) {
+  int SlotsCount = (KeyCount * 10) / 8 + 1;
+  size_t StringsByteCount = 0;
+  for (int KeyIndex = 0; KeyIndex < KeyCount; KeyIndex++) {
+    assert(Keys[KeyIndex] && "Key can't be null. ");
+    StringsByteCount += strlen(Keys[KeyIndex]) + 1;
+  }
+  
+  size_t TotalBytes = sizeof(dj_key_dictionary);
+  TotalBytes += sizeof(int) * SlotsCount * 2;
+  TotalBytes += sizeof(int) * KeyCount;
+  TotalBytes += StringsByteCount;
+  
+  dj_key_dictionary* Result = calloc(TotalBytes, 1);
+  assert(Result && "JSON: Out of memory. ");
+  Result->SlotsCount = SlotsCount;
+  Result->KeyCount   = KeyCount;
+  Result->SlotKeys   = (int*)((char*)Result + sizeof(dj_key_dictionary));
+  Result->SlotIds    = &Result->SlotKeys[SlotsCount];
+  Result->KeyOffsets = &Result->SlotIds[SlotsCount];
+  
+  char* StringCopyCurrentChar = (char*)&Result->KeyOffsets[KeyCount];
+  
+  for (int KeyIndex = 0; KeyIndex < KeyCount; KeyIndex++) {
+    dj_string Key = { strlen(Keys[KeyIndex]), Keys[KeyIndex] };
+    assert(_djFindSlot((const char*)Result, Result->SlotKeys, SlotsCount, Key, 0) < 0 && "Duplicate key. ");
+    
+    unsigned int Index = _djHashStringN(Key.Data, Key.Length) % SlotsCount;
+    while (Result->SlotKeys[Index]) {
+      Index = (Index + 1) % SlotsCount;
     }
-    ++CurrentChar;
+    
+    int Offset = (int)(StringCopyCurrentChar - (char*)Result);
+    memcpy(StringCopyCurrentChar, Key.Data, Key.Length + 1);
+    StringCopyCurrentChar += Key.Length + 1;
+    
+    Result->SlotKeys[Index]      = Offset;
+    Result->SlotIds[Index]       = KeyIndex;
+    Result->KeyOffsets[KeyIndex] = Offset;
   }
-  Context->CurrentChar = CurrentChar;
+  
+  assert(StringCopyCurrentChar == ((char*)Result + TotalBytes));
+  
+  return Result;
 }
 
-static int _djEatCharacter(dj_read_context* Context, char Character) {
-  if (*Context->CurrentChar == Character) {
-    Context->CurrentChar += 1;
-    return 1;
-  }
-  return 0;
+void djDestroyKeyDictionary(dj_key_dictionary* Dictionary) {
+  free(Dictionary);
 }
 
-static void _djIncreaseStringBufferSize(dj_read_context* Context) {
-  Context->StringBufferSize *= 2;
-  Context->StringBuffer = realloc(Context->StringBuffer, Context->StringBufferSize);
-  assert(Context->StringBuffer && "JSON: Out of memory. ");
-  // TODO: Handle this?
+static int _djFindKeyId(dj_key_dictionary* Dictionary, dj_string Key, size_t* Probes) {
+  int SlotIndex = _djFindSlot((const char*)Dictionary, Dictionary->SlotKeys, Dictionary->SlotsCount, Key, Probes);
+  return SlotIndex >= 0 ? Dictionary->SlotIds[SlotIndex] : -1;
 }
 
-static int _djPutCharInBuffer(dj_read_context* Context, int LengthBefore, char Char) {
-  if (LengthBefore >= Context->StringBufferSize) {
-    _djIncreaseStringBufferSize(Context);
+
+// ===============================================================================
+// Profile Implementation
+// ===============================================================================
+#ifdef DIR_JSON_PROFILE
+
+static const dj_string _dj_Profile_Element_Key = { 1, "*" };
+
+static int _djProfileFindOrAddNode(_dj_profile* Profile, int Parent, dj_string Key) {
+  int Child = Profile->Nodes[Parent].FirstChild;
+  while (Child >= 0) {
+    dj_string ChildKey = Profile->Nodes[Child].Key;
+    if (ChildKey.Length == Key.Length && memcmp(ChildKey.Data, Key.Data, Key.Length) == 0)
+      return Child;
+    Child = Profile->Nodes[Child].NextSibling;
   }
-  Context->StringBuffer[LengthBefore] = Char;
-  return LengthBefore + 1;
+  
+  if (Profile->NodeCount == Profile->NodeCapacity) {
+    Profile->NodeCapacity = Profile->NodeCapacity * 2;
+    Profile->Nodes = realloc(Profile->Nodes, Profile->NodeCapacity * sizeof(_dj_profile_node));
+    assert(Profile->Nodes && "JSON: Out of memory. ");
+  }
+  
+  char* KeyCopy = malloc(Key.Length + 1);
+  assert(KeyCopy && "JSON: Out of memory. ");
+  memcpy(KeyCopy, Key.Data, Key.Length);
+  KeyCopy[Key.Length] = '\0';
+  
+  Child = Profile->NodeCount++;
+  _dj_profile_node* Node = &Profile->Nodes[Child];
+  memset(Node, 0, sizeof(_dj_profile_node));
+  Node->Parent      = Parent;
+  Node->FirstChild  = -1;
+  Node->NextSibling = Profile->Nodes[Parent].FirstChild;
+  Node->Key.Data    = KeyCopy;
+  Node->Key.Length  = Key.Length;
+  Profile->Nodes[Parent].FirstChild = Child;
+  return Child;
 }
 
-static int _djPutStringInBuffer(dj_read_context* Context, int LengthBefore, const char* String) {
-  while (*String) {
-    LengthBefore = _djPutCharInBuffer(Context, LengthBefore, *String);
-    String += 1;
-  }
-  return LengthBefore;
+static void _djProfileInitialize(_dj_profile* Profile) {
+  memset(Profile, 0, sizeof(_dj_profile));
+  Profile->NodeCapacity = 64;
+  Profile->Nodes = calloc(Profile->NodeCapacity, sizeof(_dj_profile_node));
+  assert(Profile->Nodes && "JSON: Out of memory. ");
+  Profile->Nodes[0].FirstChild  = -1;
+  Profile->Nodes[0].NextSibling = -1;
+  Profile->Nodes[0].Key.Data    = "";
+  Profile->NodeCount = 1;
 }
 
-static void _djInitializationOutOfMemoryError(dj_read_context* Context, const char* Error) {
-  Context->Error = Error;
-  Context->JsonData    = "\0";
-  Context->CurrentChar = Context->JsonData;
+static void _djProfileDestroy(_dj_profile* Profile) {
+  for (int NodeIndex = 1; NodeIndex < Profile->NodeCount; NodeIndex++)
+    free((char*)Profile->Nodes[NodeIndex].Key.Data);
+  free(Profile->Nodes);
 }
 
-static dj_read_context* _djCreateReadContext() {
-  dj_read_context* Context = malloc(sizeof(dj_read_context));
-  assert(Context);
-  
-  Context->JsonDataOwnagePtr = 0;
-  Context->JsonData     = "\0";
-  Context->CurrentChar  = Context->JsonData;
-  
-  Context->CachedKey = (dj_string) { 0, 0 };
+static void _djProfileEndMember(dj_read_context* Context, _dj_profile_level* Level) {
+  if (Level->MemberNode < 0)
+    return;
+  _dj_profile_node* Node = &Context->Profile.Nodes[Level->MemberNode];
+  Node->Ticks += DIR_JSON_PROFILE_CLOCK() - Level->StartTicks;
+  Node->Bytes += Context->CurrentChar - Level->StartChar;
+  Level->MemberNode = -1;
+}
+
+static void _djProfileEnter(dj_read_context* Context) {
+  _dj_profile* Profile = &Context->Profile;
+  if (Profile->Depth++ >= DIR_JSON_READ_MAX_DEPTH)
+    return;
   
-  Context->StartOfCurrentLine = Context->JsonData;
-  Context->LineNumber = 1;
-  Context->ShouldReadValueNext = 1;
+  _dj_profile_level* Level = &Profile->Levels[Profile->Depth - 1];
+  Level->ParentNode = 0;
+  if (Profile->Depth > 1 && Profile->Levels[Profile->Depth - 2].MemberNode >= 0)
+    Level->ParentNode = Profile->Levels[Profile->Depth - 2].MemberNode;
+  Level->MemberNode = -1;
+}
+
+static void _djProfileMember(dj_read_context* Context, dj_string Key) {
+  _dj_profile* Profile = &Context->Profile;
+  if (Profile->Depth == 0 || Profile->Depth > DIR_JSON_READ_MAX_DEPTH)
+    return;
   
-  Context->Error = 0;
+  _dj_profile_level* Level = &Profile->Levels[Profile->Depth - 1];
+  _djProfileEndMember(Context, Level);
+  Level->MemberNode = _djProfileFindOrAddNode(Profile, Level->ParentNode, Key);
+  Profile->Nodes[Level->MemberNode].Count += 1;
+  Level->StartChar  = Context->CurrentChar;
+  Level->StartTicks = DIR_JSON_PROFILE_CLOCK();
+}
+
+static void _djProfileExit(dj_read_context* Context) {
+  _dj_profile* Profile = &Context->Profile;
+  if (Profile->Depth == 0)
+    return;
+  if (Profile->Depth-- > DIR_JSON_READ_MAX_DEPTH)
+    return;
+  _djProfileEndMember(Context, &Profile->Levels[Profile->Depth]);
+}
+
+static int _djProfileCompareSelfTicks(const void* A, const void* B) {
+  dj_s64 TicksA = ((const dj_s64*)A)[0];
+  dj_s64 TicksB = ((const dj_s64*)B)[0];
+  return (TicksA < TicksB) - (TicksA > TicksB);
+}
+
+static void _djProfilePrintPath(_dj_profile* Profile, int NodeIndex, FILE* File) {
+  if (NodeIndex == 0)
+    return;
+  _djProfilePrintPath(Profile, Profile->Nodes[NodeIndex].Parent, File);
+  fprintf(File, "/%s", Profile->Nodes[NodeIndex].Key.Data);
+}
+
+void djReadProfileReport(dj_read_context* Context, FILE* File, int TopCount) {
+  _dj_profile* Profile = &Context->Profile;
+  
+  // Pairs of self ticks and node index, self ticks is the time spent in the path excluding its children
+  dj_s64* Entries = malloc(Profile->NodeCount * 2 * sizeof(dj_s64));
+  assert(Entries && "JSON: Out of memory. ");
+  for (int NodeIndex = 0; NodeIndex < Profile->NodeCount; NodeIndex++) {
+    dj_s64 SelfTicks = Profile->Nodes[NodeIndex].Ticks;
+    for (int Child = Profile->Nodes[NodeIndex].FirstChild; Child >= 0; Child = Profile->Nodes[Child].NextSibling)
+      SelfTicks -= Profile->Nodes[Child].Ticks;
+    Entries[NodeIndex * 2 + 0] = SelfTicks;
+    Entries[NodeIndex * 2 + 1] = NodeIndex;
+  }
+  qsort(Entries + 2, Profile->NodeCount - 1, 2 * sizeof(dj_s64), _djProfileCompareSelfTicks);
+  
+  fprintf(File, "%14s %14s %12s %10s  %s\n", "self ticks", "total ticks", "bytes", "count", "path");
+  for (int EntryIndex = 1; EntryIndex < Profile->NodeCount && EntryIndex <= TopCount; EntryIndex++) {
+    int NodeIndex = (int)Entries[EntryIndex * 2 + 1];
+    _dj_profile_node* Node = &Profile->Nodes[NodeIndex];
+    fprintf(File, "%14lld %14lld %12llu %10llu  ", Entries[EntryIndex * 2], Node->Ticks,
+            (unsigned long long)Node->Bytes, (unsigned long long)Node->Count);
+    _djProfilePrintPath(Profile, NodeIndex, File);
+    fprintf(File, "\n");
+  }
+  
+  free(Entries);
+}
+
+#endif
+
+
+// ===============================================================================
+// Read Implementation
+// ===============================================================================
+
+#ifdef _DJ_SSE2
+static int _djCountTrailingZeros(unsigned int Mask) {
+#ifdef _MSC_VER
+  unsigned long Index;
+  _BitScanForward(&Index, Mask);
+  return (int)Index;
+#else
+  return __builtin_ctz(Mask);
+#endif
+}
+#endif
+
+// Returns the first quote or backslash, or End if there is none. Only those matters when skipping over a string.
+static const char* _djFindQuoteOrBackslash(const char* Char, const char* End) {
+#ifdef _DJ_SSE2
+  while (End - Char >= 16) {
+    __m128i Bytes = _mm_loadu_si128((const __m128i*)Char);
+    unsigned int Mask = (unsigned int)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(Bytes, _mm_set1_epi8('"')),
+                                                                     _mm_cmpeq_epi8(Bytes, _mm_set1_epi8('\\'))));
+    if (Mask)
+      return Char + _djCountTrailingZeros(Mask);
+    Char += 16;
+  }
+#endif
+  while (Char < End && *Char != '"' && *Char != '\\')
+    Char += 1;
+  return Char;
+}
+
+// Validates one UTF-8 sequence (RFC 3629) starting with a byte >= 0x80, returns its length or 0 if invalid.
+static int _djValidateUtf8(const unsigned char* Char, const unsigned char* End) {
+  unsigned char Lead = Char[0];
+  int Length;
+  unsigned char Min = 0x80, Max = 0xBF; // The range of the second byte
+  if (Lead >= 0xC2 && Lead <= 0xDF) {
+    Length = 2;
+  } else if (Lead >= 0xE0 && Lead <= 0xEF) {
+    Length = 3;
+    if (Lead == 0xE0) Min = 0xA0; // Overlong
+    if (Lead == 0xED) Max = 0x9F; // Surrogates
+  } else if (Lead >= 0xF0 && Lead <= 0xF4) {
+    Length = 4;
+    if (Lead == 0xF0) Min = 0x90; // Overlong
+    if (Lead == 0xF4) Max = 0x8F; // Above U+10FFFF
+  } else {
+    return 0;
+  }
+  
+  if (End - Char < Length || Char[1] < Min || Char[1] > Max)
+    return 0;
+  for (int Index = 2; Index < Length; Index++) {
+    if ((Char[Index] & 0xC0) != 0x80)
+      return 0;
+  }
+  return Length;
+}
+
+// Returns the character at Char or '\0' at the end of the data, buffers given to djReadFromBuffer aren't null 
+// terminated so the end of the data can't be found by reading the terminator.
+static char _djPeekChar(dj_read_context* Context, const char* Char) {
+  return Char < Context->EndOfData ? *Char : '\0';
+}
+
+static int _djIsDigitAt(dj_read_context* Context, const char* Char) {
+  return Char < Context->EndOfData && *Char >= '0' && *Char <= '9';
+}
+
+static void _djEatWhiteSpaces(dj_read_context* Context) {
+  const char* CurrentChar = Context->CurrentChar;
+  char Char;
+  while ((Char = _djPeekChar(Context, CurrentChar)) == ' ' || Char == '\n' || Char == '\r' || Char == '\t') {
+    ++CurrentChar;
+  }
+  _DJ_STAT_ADD(Context, WhitespaceSkipped, CurrentChar - Context->CurrentChar);
+  Context->CurrentChar = CurrentChar;
+}
+
+static int _djEatCharacter(dj_read_context* Context, char Character) {
+  if (_djPeekChar(Context, Context->CurrentChar) == Character) {
+    Context->CurrentChar += 1;
+    return 1;
+  }
+  return 0;
+}
+
+static void _djIncreaseStringBufferSize(dj_read_context* Context) {
+  _DJ_STAT_ADD(Context, StringBufferGrowths, 1);
+  Context->StringBufferSize *= 2;
+  Context->StringBuffer = realloc(Context->StringBuffer, Context->StringBufferSize);
+  assert(Context->StringBuffer && "JSON: Out of memory. ");
+  // TODO: Handle this?
+}
+
+static int _djPutCharInBuffer(dj_read_context* Context, int LengthBefore, char Char) {
+  if (LengthBefore >= Context->StringBufferSize) {
+    _djIncreaseStringBufferSize(Context);
+  }
+  Context->StringBuffer[LengthBefore] = Char;
+  return LengthBefore + 1;
+}
+
+static int _djPutBytesInBuffer(dj_read_context* Context, int LengthBefore, const char* Bytes, int Count) {
+  while (LengthBefore + Count > Context->StringBufferSize) {
+    _djIncreaseStringBufferSize(Context);
+  }
+  memcpy(Context->StringBuffer + LengthBefore, Bytes, Count);
+  return LengthBefore + Count;
+}
+
+// Encodes a code point as UTF-8 in the string buffer.
+static int _djPutCodePointInBuffer(dj_read_context* Context, int LengthBefore, unsigned int CodePoint) {
+  if (CodePoint >= 0x10000) {
+    LengthBefore = _djPutCharInBuffer(Context, LengthBefore, 0xF0 | ((CodePoint >> 18) & 0x07));
+    LengthBefore = _djPutCharInBuffer(Context, LengthBefore, 0x80 | ((CodePoint >> 12) & 0x3F));
+    LengthBefore = _djPutCharInBuffer(Context, LengthBefore, 0x80 | ((CodePoint >> 6 ) & 0x3F));
+    LengthBefore = _djPutCharInBuffer(Context, LengthBefore, 0x80 | ((CodePoint >> 0 ) & 0x3F));
+  } else if (CodePoint >= 0x800) {
+    LengthBefore = _djPutCharInBuffer(Context, LengthBefore, 0xE0 | ((CodePoint >> 12) & 0x0F));
+    LengthBefore = _djPutCharInBuffer(Context, LengthBefore, 0x80 | ((CodePoint >> 6 ) & 0x3F));
+    LengthBefore = _djPutCharInBuffer(Context, LengthBefore, 0x80 | ((CodePoint >> 0 ) & 0x3F));
+  } else if (CodePoint >= 0x80) {
+    LengthBefore = _djPutCharInBuffer(Context, LengthBefore, 0xC0 | ((CodePoint >> 6) & 0x1F));
+    LengthBefore = _djPutCharInBuffer(Context, LengthBefore, 0x80 | ((CodePoint >> 0) & 0x3F));
+  } else {
+    LengthBefore = _djPutCharInBuffer(Context, LengthBefore, CodePoint);
+  }
+  return LengthBefore;
+}
+
+static int _djPutStringInBuffer(dj_read_context* Context, int LengthBefore, const char* String) {
+  while (*String) {
+    LengthBefore = _djPutCharInBuffer(Context, LengthBefore, *String);
+    String += 1;
+  }
+  return LengthBefore;
+}
+
+static void _djInitializationOutOfMemoryError(dj_read_context* Context, const char* Error) {
+  Context->Error = Error;
+  Context->JsonData    = "\0";
+  Context->CurrentChar = Context->JsonData;
+  Context->EndOfData   = Context->JsonData;
+}
+
+static dj_read_context* _djCreateReadContext() {
+  dj_read_context* Context = malloc(sizeof(dj_read_context));
+  assert(Context);
+  
+  Context->JsonDataOwnagePtr = 0;
+  Context->JsonData     = "\0";
+  Context->CurrentChar  = Context->JsonData;
+  Context->EndOfData    = Context->JsonData;
+  
+  Context->Format = djFORMAT_JSON;
+  Context->ContainerDepth = 0;
+  memset(&Context->Push, 0, sizeof(Context->Push));
+  
+  Context->CachedKey = (dj_string) { 0, 0 };
+  
+  Context->ShouldReadValueNext = 1;
+  
+  Context->Error = 0;
+  Context->BytesScannedBefore = 0;
+  
+#ifdef DIR_JSON_STATS
+  memset(&Context->Stats, 0, sizeof(Context->Stats));
+#endif
+#ifdef DIR_JSON_PROFILE
+  _djProfileInitialize(&Context->Profile);
+#endif
   
   Context->StringBufferSize = 256;
   Context->StringBuffer = malloc(Context->StringBufferSize);
@@ -467,7 +1450,7 @@ static void ReadFile(dj_read_context* Context, FILE* File) {
   Context->JsonDataOwnagePtr  = Data;
   Context->JsonData           = Data;
   Context->CurrentChar        = Data;
-  Context->StartOfCurrentLine = Data;
+  Context->EndOfData          = Data + FileSize;
   
   _djEatWhiteSpaces(Context);
 }
@@ -500,6 +1483,71 @@ dj_read_context* djReadOpenAndReadFile(const char* FilePath) {
   return Context;
 }
 
+#ifdef DIR_JSON_ZLIB
+dj_read_context* djReadOpenAndReadGzipFile(const char* FilePath) {
+  dj_read_context* Context = _djCreateReadContext();
+  
+  if (djReadError(Context))
+    return Context;
+  
+  gzFile File = gzopen(FilePath, "rb");
+  if (!File) {
+    _djInitializationOutOfMemoryError(Context, "Failed to open file. ");
+    return Context;
+  }
+  gzbuffer(File, DIR_JSON_GZIP_BLOCK_SIZE);
+  
+  // The uncompressed size isn't known up front so it's decompressed a block at a time into a growing buffer
+  size_t Size = DIR_JSON_GZIP_BLOCK_SIZE;
+  size_t Used = 0;
+  char* Data = malloc(Size + 1);
+  while (Data) {
+    if (Used == Size) {
+      Size *= 2;
+      char* NewData = realloc(Data, Size + 1);
+      if (!NewData) {
+        free(Data);
+        Data = 0;
+        break;
+      }
+      Data = NewData;
+    }
+    
+    size_t AmountToRead = Size - Used < DIR_JSON_GZIP_BLOCK_SIZE ? Size - Used : DIR_JSON_GZIP_BLOCK_SIZE;
+    int AmountRead = gzread(File, Data + Used, (unsigned)AmountToRead);
+    if (AmountRead < 0) {
+      gzclose(File);
+      free(Data);
+      _djInitializationOutOfMemoryError(Context, "Couldn't decompress file. ");
+      return Context;
+    }
+    if (AmountRead == 0)
+      break;
+    Used += AmountRead;
+  }
+  int CloseResult = gzclose(File); // Reports truncated files
+  
+  if (!Data) {
+    _djInitializationOutOfMemoryError(Context, "Couldn't allocate data for the file content. ");
+    return Context;
+  }
+  if (CloseResult != Z_OK) {
+    free(Data);
+    _djInitializationOutOfMemoryError(Context, "Couldn't decompress file. ");
+    return Context;
+  }
+  Data[Used] = '\0';
+  
+  Context->JsonDataOwnagePtr  = Data;
+  Context->JsonData           = Data;
+  Context->CurrentChar        = Data;
+  Context->EndOfData          = Data + Used;
+  
+  _djEatWhiteSpaces(Context);
+  return Context;
+}
+#endif
+
 dj_read_context* djReadFromString(const char* JsonString) {
   dj_read_context* Context = _djCreateReadContext();
   
@@ -508,16 +1556,50 @@ dj_read_context* djReadFromString(const char* JsonString) {
   
   Context->JsonData           = JsonString;
   Context->CurrentChar        = JsonString;
-  Context->StartOfCurrentLine = JsonString;
+  Context->EndOfData          = JsonString + strlen(JsonString);
+  
+  _djEatWhiteSpaces(Context);
+  
+  return Context;
+}
+
+dj_read_context* djReadFromBuffer(const char* Data, size_t Length) {
+  dj_read_context* Context = _djCreateReadContext();
+  
+  if (djReadError(Context))
+    return Context;
+  
+  Context->JsonData           = Data;
+  Context->CurrentChar        = Data;
+  Context->EndOfData          = Data + Length;
   
   _djEatWhiteSpaces(Context);
   
   return Context;
 }
 
+dj_read_context* djReadFromBinary(const void* Data, size_t Length, int Format) {
+  assert(Format == djFORMAT_MSGPACK || Format == djFORMAT_CBOR);
+  dj_read_context* Context = _djCreateReadContext();
+  
+  if (djReadError(Context))
+    return Context;
+  
+  Context->Format             = Format;
+  Context->JsonData           = (const char*)Data;
+  Context->CurrentChar        = (const char*)Data;
+  Context->EndOfData          = (const char*)Data + Length;
+  
+  return Context;
+}
+
 void djReadDestroyContext(dj_read_context* Context) {
   free(Context->StringBuffer);
   free(Context->JsonDataOwnagePtr);
+  free(Context->Push.TokenData);
+#ifdef DIR_JSON_PROFILE
+  _djProfileDestroy(&Context->Profile);
+#endif
 }
 
 void djReadReportErrorIfNoErrorExists(dj_read_context* Context, const char* Start, const char* OnePastLast, 
@@ -525,8 +1607,26 @@ void djReadReportErrorIfNoErrorExists(dj_read_context* Context, const char* Star
   if (Context->Error)
     return;
   
-  int Line   = !Start ? -1 : Context->LineNumber;
-  int Column = !Start ? -1 : (int)(Start - Context->StartOfCurrentLine) + 1;
+  if (Context->Format != djFORMAT_JSON) {
+    // There is no text to show for binary formats, the binary functions report the byte offset instead
+    Start       = 0;
+    OnePastLast = 0;
+  }
+  
+  // The position isn't tracked while parsing, the line and column are found by scanning up to the error
+  int Line   = -1;
+  int Column = -1;
+  if (Start) {
+    const char* StartOfLine = Context->JsonData;
+    Line = 1;
+    for (const char* Iterator = Context->JsonData; Iterator < Start && Iterator < Context->EndOfData; Iterator++) {
+      if (*Iterator == '\n') {
+        Line += 1;
+        StartOfLine = Iterator + 1;
+      }
+    }
+    Column = (int)(Start - StartOfLine) + 1;
+  }
   
   int AmountWritten = 0;
   if (DIR_JSON_ERROR_PREFIX_STRING) { // Write prefix string
@@ -566,29 +1666,23 @@ void djReadReportErrorIfNoErrorExists(dj_read_context* Context, const char* Star
   }
   va_end(VariableArguments);
   
-  if (DIR_JSON_ERROR_MAX_SHOWN_CONTENT_COUNT) {
+  if (DIR_JSON_ERROR_MAX_SHOWN_CONTENT_COUNT && Start) {
     const char* StartFrom    = Start;
     const char* EndOneBefore = OnePastLast;
     int AmountSearchedBackwards = 0;
     int AmountSearchedForwards  = 0;
     
     for (; AmountSearchedBackwards < DIR_JSON_ERROR_MAX_SHOWN_CONTENT_COUNT; AmountSearchedBackwards++) {
-      if (StartFrom == Context->JsonData)
-        break;
-      if (*StartFrom == '\r' || *StartFrom == '\n') {
-        StartFrom += 1;
+      if (StartFrom == Context->JsonData || StartFrom[-1] == '\r' || StartFrom[-1] == '\n')
         break;
-      }
       StartFrom -= 1;
     }
     
-    if (*Context->CurrentChar != '\0') {
-      for (; AmountSearchedForwards < DIR_JSON_ERROR_MAX_SHOWN_CONTENT_COUNT; AmountSearchedForwards++) {
-        if (*EndOneBefore == '\0' || *EndOneBefore == '\r' || *EndOneBefore == '\n') {
-          break;
-        }
-        EndOneBefore += 1;
+    for (; AmountSearchedForwards < DIR_JSON_ERROR_MAX_SHOWN_CONTENT_COUNT; AmountSearchedForwards++) {
+      if (EndOneBefore >= Context->EndOfData || *EndOneBefore == '\r' || *EndOneBefore == '\n') {
+        break;
       }
+      EndOneBefore += 1;
     }
     
     if (AmountSearchedForwards + AmountSearchedBackwards > DIR_JSON_ERROR_MAX_SHOWN_CONTENT_COUNT) {
@@ -596,7 +1690,7 @@ void djReadReportErrorIfNoErrorExists(dj_read_context* Context, const char* Star
         EndOneBefore = OnePastLast + DIR_JSON_ERROR_MAX_SHOWN_CONTENT_COUNT / 2;
       }
       if (AmountSearchedBackwards > DIR_JSON_ERROR_MAX_SHOWN_CONTENT_COUNT / 2) {
-        EndOneBefore = Start - DIR_JSON_ERROR_MAX_SHOWN_CONTENT_COUNT / 2;
+        StartFrom = Start - DIR_JSON_ERROR_MAX_SHOWN_CONTENT_COUNT / 2;
       }
     }
     
@@ -605,7 +1699,7 @@ void djReadReportErrorIfNoErrorExists(dj_read_context* Context, const char* Star
       AmountWritten = _djPutStringInBuffer(Context, AmountWritten, "...");
     
     const char* Iterator = StartFrom;
-    while (*Iterator && Iterator < EndOneBefore) {
+    while (Iterator < EndOneBefore && Iterator < Context->EndOfData) {
       AmountWritten = _djPutCharInBuffer(Context, AmountWritten, *Iterator);
       Iterator += 1;
     }
@@ -635,52 +1729,453 @@ void djReadReportErrorIfNoErrorExists(dj_read_context* Context, const char* Star
   
   AmountWritten = _djPutCharInBuffer(Context, AmountWritten, '\0');
   Context->Error = Context->StringBuffer;
+  Context->BytesScannedBefore += Context->CurrentChar - Context->JsonData;
   Context->JsonData    = "\0";
   Context->CurrentChar = Context->JsonData;
+  Context->EndOfData   = Context->JsonData;
 }
 
 const char* djReadError(dj_read_context* Context) {
   return Context->Error;
 }
 
-int djReadKey(dj_read_context* Context, dj_string* KeyOut) {
-  if (Context->CachedKey.Data) {
-    *KeyOut = Context->CachedKey;
-    Context->CachedKey.Data = 0;
-    return 1;
+dj_read_stats djReadGetStats(dj_read_context* Context) {
+  dj_read_stats Stats = { 0 };
+#ifdef DIR_JSON_STATS
+  Stats = Context->Stats;
+#endif
+  Stats.BytesScanned = Context->BytesScannedBefore + (Context->CurrentChar - Context->JsonData);
+  return Stats;
+}
+
+// ===============================================================================
+// Binary Read Implementation
+// ===============================================================================
+
+enum {
+  _dj_Binary_Invalid,
+  _dj_Binary_Object,
+  _dj_Binary_Array,
+  _dj_Binary_String,
+  _dj_Binary_Integer,
+  _dj_Binary_Float,
+  _dj_Binary_Bool,
+  _dj_Binary_Null,
+  _dj_Binary_Break
+};
+
+typedef struct {
+  int Type;
+  int HeaderSize;
+  dj_s64 Length;  // Byte count for strings, member count for containers, -1 for indefinite length containers
+  dj_s64 Integer; // Value of integers and booleans
+  dj_f64 Float;
+} _dj_binary_head;
+
+static void _djBinaryReportError(dj_read_context* Context, const char* Message) {
+  djReadReportErrorIfNoErrorExists(Context, 0, 0, "%sByte offset %lld. ", Message, 
+                                   (long long)(Context->CurrentChar - Context->JsonData));
+}
+
+static uint64_t _djReadBigEndian(const char* Data, int ByteCount) {
+  uint64_t Value = 0;
+  for (int ByteIndex = 0; ByteIndex < ByteCount; ByteIndex++) {
+    Value = (Value << 8) | (unsigned char)Data[ByteIndex];
+  }
+  return Value;
+}
+
+static dj_f64 _djBitsToF64(uint64_t Bits) {
+  dj_f64 Value;
+  memcpy(&Value, &Bits, sizeof(Value));
+  return Value;
+}
+
+static dj_f64 _djBitsToF32(uint32_t Bits) {
+  float Value;
+  memcpy(&Value, &Bits, sizeof(Value));
+  return Value;
+}
+
+static dj_f64 _djBitsToF16(unsigned int Half) {
+  uint64_t Sign     = (uint64_t)(Half & 0x8000) << 48;
+  int      Exponent = (Half >> 10) & 0x1F;
+  uint64_t Mantissa = Half & 0x3FF;
+  
+  if (Exponent == 0) {
+    dj_f64 Value = (dj_f64)Mantissa / 16777216.0; // Subnormal, Mantissa * 2^-24
+    return Sign ? -Value : Value;
+  } else if (Exponent == 31) {
+    return _djBitsToF64(Sign | ((uint64_t)0x7FF << 52) | (Mantissa << 42));
   }
+  return _djBitsToF64(Sign | ((uint64_t)(Exponent - 15 + 1023) << 52) | (Mantissa << 42));
+}
+
+// Decodes the head of the next value without consuming it. Returns 0 if the data is truncated or not supported.
+static int _djBinaryPeekHead(dj_read_context* Context, _dj_binary_head* Head) {
+  const char* Data = Context->CurrentChar;
+  dj_s64 Available = Context->EndOfData - Data;
+  int ArgumentSize = 0;
+  int IsSigned = 0;
   
-  if (Context->ShouldReadValueNext) {
-    if (!_djEatCharacter(Context, '{')) {
-      djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar, Context->CurrentChar + 1,
-                                       "Expected a object. ");
-      return 0;
+  memset(Head, 0, sizeof(*Head));
+  if (Available < 1)
+    return 0;
+  
+  if (Context->Format == djFORMAT_MSGPACK) {
+    unsigned char Byte = (unsigned char)Data[0];
+    
+    if (Byte <= 0x7F) {
+      Head->Type = _dj_Binary_Integer;
+      Head->Integer = Byte;
+    } else if (Byte <= 0x8F) {
+      Head->Type = _dj_Binary_Object;
+      Head->Length = Byte & 0x0F;
+    } else if (Byte <= 0x9F) {
+      Head->Type = _dj_Binary_Array;
+      Head->Length = Byte & 0x0F;
+    } else if (Byte <= 0xBF) {
+      Head->Type = _dj_Binary_String;
+      Head->Length = Byte & 0x1F;
+    } else if (Byte >= 0xE0) {
+      Head->Type = _dj_Binary_Integer;
+      Head->Integer = (signed char)Byte;
+    } else {
+      switch (Byte) {
+        case 0xC0: Head->Type = _dj_Binary_Null; break;
+        case 0xC2: Head->Type = _dj_Binary_Bool; Head->Integer = 0; break;
+        case 0xC3: Head->Type = _dj_Binary_Bool; Head->Integer = 1; break;
+        case 0xC4: case 0xD9: Head->Type = _dj_Binary_String;  ArgumentSize = 1; break;
+        case 0xC5: case 0xDA: Head->Type = _dj_Binary_String;  ArgumentSize = 2; break;
+        case 0xC6: case 0xDB: Head->Type = _dj_Binary_String;  ArgumentSize = 4; break;
+        case 0xCA:            Head->Type = _dj_Binary_Float;   ArgumentSize = 4; break;
+        case 0xCB:            Head->Type = _dj_Binary_Float;   ArgumentSize = 8; break;
+        case 0xCC:            Head->Type = _dj_Binary_Integer; ArgumentSize = 1; break;
+        case 0xCD:            Head->Type = _dj_Binary_Integer; ArgumentSize = 2; break;
+        case 0xCE:            Head->Type = _dj_Binary_Integer; ArgumentSize = 4; break;
+        case 0xCF:            Head->Type = _dj_Binary_Integer; ArgumentSize = 8; break;
+        case 0xD0:            Head->Type = _dj_Binary_Integer; ArgumentSize = 1; IsSigned = 1; break;
+        case 0xD1:            Head->Type = _dj_Binary_Integer; ArgumentSize = 2; IsSigned = 1; break;
+        case 0xD2:            Head->Type = _dj_Binary_Integer; ArgumentSize = 4; IsSigned = 1; break;
+        case 0xD3:            Head->Type = _dj_Binary_Integer; ArgumentSize = 8; IsSigned = 1; break;
+        case 0xDC:            Head->Type = _dj_Binary_Array;   ArgumentSize = 2; break;
+        case 0xDD:            Head->Type = _dj_Binary_Array;   ArgumentSize = 4; break;
+        case 0xDE:            Head->Type = _dj_Binary_Object;  ArgumentSize = 2; break;
+        case 0xDF:            Head->Type = _dj_Binary_Object;  ArgumentSize = 4; break;
+        default: return 0; // Extension types aren't supported
+      }
     }
-    _djEatWhiteSpaces(Context);
     
-    if (_djEatCharacter(Context, '}')) {
-      Context->ShouldReadValueNext = 0;
-      _djEatWhiteSpaces(Context);
+    if (Available < 1 + ArgumentSize)
       return 0;
-    }
+    Head->HeaderSize = 1 + ArgumentSize;
     
-    // Context->ShouldReadValueNext = 0; // This is overwritten below to allow djReadString to function
-  } else if (_djEatCharacter(Context, '}')) {
-    _djEatWhiteSpaces(Context);
-    return 0;
-  } else if (!_djEatCharacter(Context, ',')) {
-    djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar, Context->CurrentChar + 1,
-                                     "Expected a ',' or '}'. ");
-    return 0;
+    if (ArgumentSize) {
+      uint64_t Argument = _djReadBigEndian(Data + 1, ArgumentSize);
+      if (Head->Type == _dj_Binary_Integer) {
+        if (IsSigned) {
+          int Shift = 64 - 8 * ArgumentSize;
+          Head->Integer = (dj_s64)(Argument << Shift) >> Shift;
+        } else if (Argument > INT64_MAX) {
+          return 0;
+        } else {
+          Head->Integer = (dj_s64)Argument;
+        }
+      } else if (Head->Type == _dj_Binary_Float) {
+        Head->Float = ArgumentSize == 4 ? _djBitsToF32((uint32_t)Argument) : _djBitsToF64(Argument);
+      } else {
+        Head->Length = (dj_s64)Argument;
+      }
+    }
+  } else {
+    int TagBytes = 0;
+    while (1) {
+      unsigned char Byte = (unsigned char)Data[TagBytes];
+      int MajorType      = Byte >> 5;
+      int AdditionalInfo = Byte & 0x1F;
+      uint64_t Argument  = AdditionalInfo;
+      
+      if (AdditionalInfo >= 24 && AdditionalInfo <= 27) {
+        ArgumentSize = 1 << (AdditionalInfo - 24);
+        if (Available < TagBytes + 1 + ArgumentSize)
+          return 0;
+        Argument = _djReadBigEndian(Data + TagBytes + 1, ArgumentSize);
+      } else if (AdditionalInfo > 27 && AdditionalInfo != 31) {
+        return 0;
+      } else if (AdditionalInfo == 31 && MajorType != 4 && MajorType != 5 && MajorType != 7) {
+        return 0; // Indefinite length strings can't be returned without copying
+      }
+      
+      if (MajorType == 6) {
+        // Tags are ignored, the tagged value is read as is
+        TagBytes += 1 + ArgumentSize;
+        ArgumentSize = 0;
+        if (Available < TagBytes + 1)
+          return 0;
+        continue;
+      }
+      
+      Head->HeaderSize = TagBytes + 1 + ArgumentSize;
+      switch (MajorType) {
+        case 0:
+        case 1: {
+          if (Argument > INT64_MAX)
+            return 0;
+          Head->Type = _dj_Binary_Integer;
+          Head->Integer = MajorType == 0 ? (dj_s64)Argument : -1 - (dj_s64)Argument;
+        } break;
+        case 2:
+        case 3: {
+          Head->Type = _dj_Binary_String;
+          Head->Length = (dj_s64)Argument;
+        } break;
+        case 4:
+        case 5: {
+          Head->Type = MajorType == 4 ? _dj_Binary_Array : _dj_Binary_Object;
+          Head->Length = AdditionalInfo == 31 ? -1 : (dj_s64)Argument;
+        } break;
+        case 7: {
+          switch (AdditionalInfo) {
+            case 20: Head->Type = _dj_Binary_Bool; Head->Integer = 0; break;
+            case 21: Head->Type = _dj_Binary_Bool; Head->Integer = 1; break;
+            case 22: case 23: Head->Type = _dj_Binary_Null; break;
+            case 25: Head->Type = _dj_Binary_Float; Head->Float = _djBitsToF16((unsigned int)Argument); break;
+            case 26: Head->Type = _dj_Binary_Float; Head->Float = _djBitsToF32((uint32_t)Argument);     break;
+            case 27: Head->Type = _dj_Binary_Float; Head->Float = _djBitsToF64(Argument);               break;
+            case 31: Head->Type = _dj_Binary_Break; break;
+            default: return 0;
+          }
+        } break;
+      }
+      break;
+    }
   }
-  _djEatWhiteSpaces(Context);
   
-  Context->ShouldReadValueNext = 1;
-  *KeyOut = djReadString(Context);
-  if (!KeyOut->Data) {
+  if (Head->Type == _dj_Binary_String && Head->Length > Available - Head->HeaderSize)
     return 0;
-  }
   
+  return 1;
+}
+
+static int _djBinaryReadHead(dj_read_context* Context, _dj_binary_head* Head, int ExpectedType, const char* Error) {
+  if (!_djBinaryPeekHead(Context, Head) || Head->Type != ExpectedType) {
+    _djBinaryReportError(Context, Error);
+    return 0;
+  }
+  Context->CurrentChar += Head->HeaderSize;
+  return 1;
+}
+
+static int _djBinaryEnterContainer(dj_read_context* Context, int IsObject) {
+  _dj_binary_head Head;
+  if (!_djBinaryReadHead(Context, &Head, IsObject ? _dj_Binary_Object : _dj_Binary_Array,
+                         IsObject ? "Expected a object. " : "Expected an array. "))
+    return 0;
+  
+  if (Context->ContainerDepth == DIR_JSON_READ_MAX_DEPTH) {
+    _djBinaryReportError(Context, "Containers are nested too deeply. ");
+    return 0;
+  }
+  
+  _dj_read_container* Container = &Context->Containers[Context->ContainerDepth++];
+  Container->Remaining = Head.Length;
+  Container->IsObject  = IsObject;
+  _DJ_PROFILE_ENTER(Context);
+  return 1;
+}
+
+// Returns 1 if the current container has another member, otherwise the container is exited and 0 is returned.
+static int _djBinaryNextMember(dj_read_context* Context, int IsObject) {
+  if (Context->Error)
+    return 0;
+  
+  if (!Context->ContainerDepth || Context->Containers[Context->ContainerDepth - 1].IsObject != IsObject) {
+    _djBinaryReportError(Context, IsObject ? "Expected a object. " : "Expected an array. ");
+    return 0;
+  }
+  
+  _dj_read_container* Container = &Context->Containers[Context->ContainerDepth - 1];
+  if (Container->Remaining > 0) {
+    Container->Remaining -= 1;
+    return 1;
+  } else if (Container->Remaining < 0) {
+    if (Context->CurrentChar == Context->EndOfData) {
+      _djBinaryReportError(Context, "Reached end of the data before the end of the container. ");
+      return 0;
+    }
+    if ((unsigned char)*Context->CurrentChar != 0xFF)
+      return 1;
+    Context->CurrentChar += 1;
+  }
+  
+  Context->ContainerDepth -= 1;
+  Context->ShouldReadValueNext = 0;
+  _DJ_PROFILE_EXIT(Context);
+  return 0;
+}
+
+static dj_string _djBinaryReadString(dj_read_context* Context) {
+  const dj_string ErrorResult = { 0, "" };
+  _dj_binary_head Head;
+  if (!_djBinaryReadHead(Context, &Head, _dj_Binary_String, "Expected a string. "))
+    return ErrorResult;
+  
+  dj_string Result;
+  Result.Length = (size_t)Head.Length;
+  Result.Data   = Context->CurrentChar;
+  Context->CurrentChar += Head.Length;
+  return Result;
+}
+
+static int _djBinaryReadKey(dj_read_context* Context, dj_string* KeyOut) {
+  if (Context->ShouldReadValueNext && !_djBinaryEnterContainer(Context, 1))
+    return 0;
+  
+  if (!_djBinaryNextMember(Context, 1))
+    return 0;
+  
+  *KeyOut = _djBinaryReadString(Context);
+  Context->ShouldReadValueNext = 1;
+  _DJ_PROFILE_MEMBER(Context, *KeyOut);
+  return !Context->Error;
+}
+
+static int _djBinaryReadObjectEnd(dj_read_context* Context) {
+  if (Context->CachedKey.Data || _djBinaryNextMember(Context, 1)) {
+    _djBinaryReportError(Context, "Expected end of object. ");
+    return 0;
+  }
+  return !Context->Error;
+}
+
+static int _djBinaryReadArray(dj_read_context* Context) {
+  if (Context->ShouldReadValueNext && !_djBinaryEnterContainer(Context, 0))
+    return 0;
+  
+  if (!_djBinaryNextMember(Context, 0))
+    return 0;
+  
+  Context->ShouldReadValueNext = 1;
+  _DJ_PROFILE_MEMBER(Context, _dj_Profile_Element_Key);
+  return 1;
+}
+
+static dj_s64 _djBinaryReadNumber(dj_read_context* Context, int AllowFloat, dj_f64* FloatOut) {
+  _dj_binary_head Head;
+  if (!_djBinaryPeekHead(Context, &Head) || 
+      (Head.Type != _dj_Binary_Integer && (!AllowFloat || Head.Type != _dj_Binary_Float))) {
+    _djBinaryReportError(Context, AllowFloat ? "Expected a number. " : "Expected a integer. ");
+    return 0;
+  }
+  Context->CurrentChar += Head.HeaderSize;
+  if (FloatOut)
+    *FloatOut = Head.Type == _dj_Binary_Float ? Head.Float : (dj_f64)Head.Integer;
+  return Head.Integer;
+}
+
+static int _djBinaryNextIs(dj_read_context* Context, int Type) {
+  _dj_binary_head Head;
+  return _djBinaryPeekHead(Context, &Head) && Head.Type == Type;
+}
+
+static void _djBinarySkipValue(dj_read_context* Context, int Depth) {
+  _dj_binary_head Head;
+  if (!_djBinaryPeekHead(Context, &Head) || Head.Type == _dj_Binary_Break) {
+    _djBinaryReportError(Context, "Expected a value. ");
+    return;
+  }
+  if (Depth == DIR_JSON_READ_MAX_DEPTH) {
+    _djBinaryReportError(Context, "Containers are nested too deeply. ");
+    return;
+  }
+  
+  Context->CurrentChar += Head.HeaderSize;
+  if (Head.Type == _dj_Binary_String) {
+    Context->CurrentChar += Head.Length;
+  } else if (Head.Type == _dj_Binary_Object || Head.Type == _dj_Binary_Array) {
+    if (Head.Length < 0) {
+      while (!Context->Error) {
+        if (Context->CurrentChar == Context->EndOfData) {
+          _djBinaryReportError(Context, "Reached end of the data before the end of the container. ");
+          return;
+        }
+        if ((unsigned char)*Context->CurrentChar == 0xFF) {
+          Context->CurrentChar += 1;
+          break;
+        }
+        _djBinarySkipValue(Context, Depth + 1);
+      }
+    } else {
+      dj_s64 ValueCount = Head.Type == _dj_Binary_Object ? Head.Length * 2 : Head.Length;
+      for (dj_s64 ValueIndex = 0; ValueIndex < ValueCount && !Context->Error; ValueIndex++) {
+        _djBinarySkipValue(Context, Depth + 1);
+      }
+    }
+  }
+}
+
+static int _djReadKeyPrefix(dj_read_context* Context);
+static int _djReadKeySuffix(dj_read_context* Context);
+
+int djReadKey(dj_read_context* Context, dj_string* KeyOut) {
+  if (Context->CachedKey.Data) {
+    *KeyOut = Context->CachedKey;
+    Context->CachedKey.Data = 0;
+    return 1;
+  }
+  
+  if (Context->Format != djFORMAT_JSON)
+    return _djBinaryReadKey(Context, KeyOut);
+  
+  if (!_djReadKeyPrefix(Context))
+    return 0;
+  
+  Context->ShouldReadValueNext = 1;
+  *KeyOut = djReadString(Context);
+  if (Context->Error) {
+    return 0;
+  }
+  
+  if (!_djReadKeySuffix(Context))
+    return 0;
+  _DJ_PROFILE_MEMBER(Context, *KeyOut);
+  return 1;
+}
+
+// Reads the '{', ',' or '}' in front of a key. Returns 1 if a key follows.
+static int _djReadKeyPrefix(dj_read_context* Context) {
+  if (Context->ShouldReadValueNext) {
+    if (!_djEatCharacter(Context, '{')) {
+      djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar, Context->CurrentChar + 1,
+                                       "Expected a object. ");
+      return 0;
+    }
+    _djEatWhiteSpaces(Context);
+    _DJ_PROFILE_ENTER(Context);
+    
+    if (_djEatCharacter(Context, '}')) {
+      Context->ShouldReadValueNext = 0;
+      _djEatWhiteSpaces(Context);
+      _DJ_PROFILE_EXIT(Context);
+      return 0;
+    }
+    
+    // Context->ShouldReadValueNext = 0; // This is overwritten below to allow djReadString to function
+  } else if (_djEatCharacter(Context, '}')) {
+    _djEatWhiteSpaces(Context);
+    _DJ_PROFILE_EXIT(Context);
+    return 0;
+  } else if (!_djEatCharacter(Context, ',')) {
+    djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar, Context->CurrentChar + 1,
+                                     "Expected a ',' or '}'. ");
+    return 0;
+  }
+  _djEatWhiteSpaces(Context);
+  return 1;
+}
+
+// Reads the ':' after a key.
+static int _djReadKeySuffix(dj_read_context* Context) {
   if (!_djEatCharacter(Context, ':')) {
     djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar, Context->CurrentChar + 1,
                                      "A colon needs to follow the key for each member.");
@@ -692,12 +2187,92 @@ int djReadKey(dj_read_context* Context, dj_string* KeyOut) {
   return 1;
 }
 
+// Scans a string without unescaping it, RawOut is set to the content between the quotes.
+// Returns 1 if the string contains escape sequences, 0 if not and -1 if an error occured.
+static int _djReadRawString(dj_read_context* Context, dj_string* RawOut) {
+  const char* CurrentChar = Context->CurrentChar;
+  int HasEscapes = 0;
+  
+  if (_djPeekChar(Context, CurrentChar) != '"') {
+    djReadReportErrorIfNoErrorExists(Context, CurrentChar, CurrentChar + 1, "Expected a string. ");
+    return -1;
+  }
+  CurrentChar += 1;
+  
+  const char* Start = CurrentChar;
+  while (_djPeekChar(Context, CurrentChar) != '"') {
+    if (_djPeekChar(Context, CurrentChar) == '\\') {
+      HasEscapes = 1;
+      CurrentChar += 1;
+    }
+    if (!_djPeekChar(Context, CurrentChar)) {
+      djReadReportErrorIfNoErrorExists(Context, CurrentChar, CurrentChar + 1,
+                                       "Reached end of the file before closing the string. ");
+      return -1;
+    }
+    CurrentChar += 1;
+  }
+  
+  RawOut->Data   = Start;
+  RawOut->Length = CurrentChar - Start;
+  Context->CurrentChar = CurrentChar + 1;
+  _djEatWhiteSpaces(Context);
+  return HasEscapes;
+}
+
+// Same as djReadKey but the key isn't unescaped, for binary formats this is the same as djReadKey.
+static int _djReadRawKey(dj_read_context* Context, dj_string* RawKeyOut, int* HasEscapesOut) {
+  assert(!Context->CachedKey.Data);
+  *HasEscapesOut = 0;
+  
+  if (Context->Format != djFORMAT_JSON)
+    return djReadKey(Context, RawKeyOut);
+  
+  if (!_djReadKeyPrefix(Context))
+    return 0;
+  
+  *HasEscapesOut = _djReadRawString(Context, RawKeyOut);
+  if (*HasEscapesOut < 0)
+    return 0;
+  
+  if (!_djReadKeySuffix(Context))
+    return 0;
+  _DJ_PROFILE_MEMBER(Context, *RawKeyOut);
+  return 1;
+}
+
+// Unescapes a string returned by _djReadRawString or _djReadRawKey, the result is stored in the string buffer.
+static dj_string _djUnescapeRawString(dj_read_context* Context, dj_string Raw) {
+  // Let djReadString do the work by pointing the context at the string
+  const char* CurrentChar = Context->CurrentChar;
+  int ShouldReadValueNext = Context->ShouldReadValueNext;
+  Context->CurrentChar = Raw.Data - 1;
+  Context->ShouldReadValueNext = 1;
+  
+  dj_string Result = djReadString(Context);
+  
+  if (!Context->Error) {
+    Context->CurrentChar = CurrentChar;
+    Context->ShouldReadValueNext = ShouldReadValueNext;
+  }
+  return Result;
+}
+
 int djReadMandatoryKey(dj_read_context* Context, const char* ExpectedKey) {
   dj_string Key;
-  djReadKey(Context, &Key);
-  if (strcmp(Key.Data, ExpectedKey) != 0) {
+  if (!djReadKey(Context, &Key)) {
+    djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar - 1, Context->CurrentChar,
+                                     "Unexpected end of object, expected key '%s'.", ExpectedKey);
+    return 0;
+  }
+  
+  if (!_djStringEquals(Key, ExpectedKey)) {
+    char* KeyCopy = malloc(Key.Length + 1);
+    memcpy(KeyCopy, Key.Data, Key.Length);
+    KeyCopy[Key.Length] = '\0';
     djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar, Context->CurrentChar + 1,
-                                     "Unexpected key found, expected '%s' got '%s'.", ExpectedKey, Key.Data);
+                                     "Unexpected key found, expected '%s' got '%s'.", ExpectedKey, KeyCopy);
+    free(KeyCopy);
     return 0;
   }
   return 1;
@@ -705,11 +2280,13 @@ int djReadMandatoryKey(dj_read_context* Context, const char* ExpectedKey) {
 
 int djReadOptionalKey(dj_read_context* Context, const char* ExpectedKey) {
   dj_string Key;
-  djReadKey(Context, &Key);
+  if (!djReadKey(Context, &Key)) {
+    return 0;
+  }
   
   int Success = 0;
   
-  if (strcmp(Key.Data, ExpectedKey) == 0) {
+  if (_djStringEquals(Key, ExpectedKey)) {
     Success = 1;
   } else {
     Context->CachedKey = Key;
@@ -718,7 +2295,83 @@ int djReadOptionalKey(dj_read_context* Context, const char* ExpectedKey) {
   return Success;
 }
 
+void djReadSetKeyDictionary(dj_read_context* Context, dj_key_dictionary* Dictionary) {
+  Context->KeyDictionary = Dictionary;
+}
+
+// Same as djReadKey but the key is looked up in the dictionary, unescaping it only if it has escape sequences.
+static int _djReadKeyAndId(dj_read_context* Context, dj_string* KeyOut, int* IdOut) {
+  assert(Context->KeyDictionary && "A key dictionary needs to be set with djReadSetKeyDictionary. ");
+  *IdOut = -1;
+  
+  if (Context->CachedKey.Data) {
+    *KeyOut = Context->CachedKey;
+    Context->CachedKey.Data = 0;
+  } else {
+    int HasEscapes;
+    if (!_djReadRawKey(Context, KeyOut, &HasEscapes))
+      return 0;
+    if (HasEscapes) {
+      *KeyOut = _djUnescapeRawString(Context, *KeyOut);
+      if (Context->Error)
+        return 0;
+    }
+  }
+  
+  *IdOut = _djFindKeyId(Context->KeyDictionary, *KeyOut, _DJ_STAT_PTR(Context, HashProbes));
+  return 1;
+}
+
+int djReadKeyId(dj_read_context* Context, int* IdOut) {
+  dj_string Key;
+  return _djReadKeyAndId(Context, &Key, IdOut);
+}
+
+int djReadMandatoryKeyId(dj_read_context* Context, int Id) {
+  assert(Id >= 0 && Id < Context->KeyDictionary->KeyCount);
+  const char* ExpectedKey = (const char*)Context->KeyDictionary + Context->KeyDictionary->KeyOffsets[Id];
+  
+  dj_string Key;
+  int KeyId;
+  if (!_djReadKeyAndId(Context, &Key, &KeyId)) {
+    djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar - 1, Context->CurrentChar,
+                                     "Unexpected end of object, expected key '%s'.", ExpectedKey);
+    return 0;
+  }
+  
+  if (KeyId != Id) {
+    char* KeyCopy = malloc(Key.Length + 1);
+    memcpy(KeyCopy, Key.Data, Key.Length);
+    KeyCopy[Key.Length] = '\0';
+    djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar, Context->CurrentChar + 1,
+                                     "Unexpected key found, expected '%s' got '%s'.", ExpectedKey, KeyCopy);
+    free(KeyCopy);
+    return 0;
+  }
+  return 1;
+}
+
+int djReadOptionalKeyId(dj_read_context* Context, int Id) {
+  dj_string Key;
+  int KeyId;
+  if (!_djReadKeyAndId(Context, &Key, &KeyId)) {
+    return 0;
+  }
+  
+  if (KeyId != Id) {
+    // The key is copied so the next djReadKey returns it null terminated like always
+    if (Context->Format == djFORMAT_JSON && Key.Data != Context->StringBuffer)
+      Key = _djUnescapeRawString(Context, Key);
+    Context->CachedKey = Key;
+    return 0;
+  }
+  return 1;
+}
+
 int djReadObjectEnd(dj_read_context* Context) {
+  if (Context->Format != djFORMAT_JSON)
+    return _djBinaryReadObjectEnd(Context);
+  
   if (!_djEatCharacter(Context, '}')) {
     djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar, Context->CurrentChar + 1,
                                      "Expected end of object.");
@@ -726,6 +2379,7 @@ int djReadObjectEnd(dj_read_context* Context) {
   }
   
   _djEatWhiteSpaces(Context);
+  _DJ_PROFILE_EXIT(Context);
   return 1;
 }
 
@@ -733,26 +2387,12 @@ void djReadObjectUsingCallbacks(dj_read_context* Context, dj_callbacks_object* O
   int MandatoryMembersFound = 0;
   dj_string Key;
   while (djReadKey(Context, &Key)) {
-    unsigned int Hash = _djHashString(Key.Data);
-    
-    unsigned int SlotIndex =  Hash % Object->SlotsCount;
-    
-    int Found = 0;
-    int IsMandatory;
-    while (Object->MemberKeys[SlotIndex]) {
-      IsMandatory = Object->MemberKeys[SlotIndex] & _dj_Mandatory_Flag;
-      char* SlotKey = (char*)Object + (Object->MemberKeys[SlotIndex] & ~_dj_Mandatory_Flag);
-      
-      if (strcmp(Key.Data, SlotKey) == 0) {
-        Found = 1;
-        break;
-      }
-      
-      SlotIndex = (SlotIndex + 1) % Object->SlotsCount;
-    }
+    int SlotIndex = _djFindSlot((const char*)Object, Object->MemberKeys, Object->SlotsCount, Key,
+                                _DJ_STAT_PTR(Context, HashProbes));
     
-    if (Found) {
-      if (IsMandatory)
+    _DJ_STAT_ADD(Context, CallbackDispatches, 1);
+    if (SlotIndex >= 0) {
+      if (Object->MemberKeys[SlotIndex] & _dj_Mandatory_Flag)
         MandatoryMembersFound += 1;
       Object->MemberCallbacks[SlotIndex](Context, Ptr);
     } else {
@@ -768,6 +2408,9 @@ void djReadObjectUsingCallbacks(dj_read_context* Context, dj_callbacks_object* O
 }
 
 int djReadArray(dj_read_context* Context) {
+  if (Context->Format != djFORMAT_JSON)
+    return _djBinaryReadArray(Context);
+  
   if (Context->ShouldReadValueNext) {
     if (!_djEatCharacter(Context, '[')) {
       djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar, Context->CurrentChar + 1, 
@@ -775,13 +2418,16 @@ int djReadArray(dj_read_context* Context) {
       return 0;
     }
     _djEatWhiteSpaces(Context);
+    _DJ_PROFILE_ENTER(Context);
     if (_djEatCharacter(Context, ']')) {
       Context->ShouldReadValueNext = 0;
       _djEatWhiteSpaces(Context);
+      _DJ_PROFILE_EXIT(Context);
       return 0;
     }
   } else if (_djEatCharacter(Context, ']')) {
     _djEatWhiteSpaces(Context);
+    _DJ_PROFILE_EXIT(Context);
     return 0;
   } else if (!_djEatCharacter(Context, ',')) {
     djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar, Context->CurrentChar + 1,
@@ -791,6 +2437,7 @@ int djReadArray(dj_read_context* Context) {
   
   Context->ShouldReadValueNext = 1;
   _djEatWhiteSpaces(Context);
+  _DJ_PROFILE_MEMBER(Context, _dj_Profile_Element_Key);
   return 1;
 }
 
@@ -798,13 +2445,21 @@ int djReadBool(dj_read_context* Context) {
   assert(Context->ShouldReadValueNext);
   Context->ShouldReadValueNext = 0;
   
+  if (Context->Format != djFORMAT_JSON) {
+    _dj_binary_head Head;
+    return _djBinaryReadHead(Context, &Head, _dj_Binary_Bool, "Expected a boolean ('true' or 'false'. )") ? 
+      (int)Head.Integer : 0;
+  }
+  
   int Result;
   static const char TRUE_STR[]  = "true";
   static const char FALSE_STR[] = "false";
-  if (memcmp(Context->CurrentChar, TRUE_STR, sizeof(TRUE_STR) - 1) == 0) {
+  size_t Available = Context->EndOfData - Context->CurrentChar;
+  if (Available >= sizeof(TRUE_STR) - 1 && memcmp(Context->CurrentChar, TRUE_STR, sizeof(TRUE_STR) - 1) == 0) {
     Context->CurrentChar += sizeof(TRUE_STR) - 1;
     Result = 1;
-  } else if (memcmp(Context->CurrentChar, FALSE_STR, sizeof(FALSE_STR) - 1) == 0) {
+  } else if (Available >= sizeof(FALSE_STR) - 1 && 
+             memcmp(Context->CurrentChar, FALSE_STR, sizeof(FALSE_STR) - 1) == 0) {
     Context->CurrentChar += sizeof(FALSE_STR) - 1;
     Result = 0;
   } else {
@@ -821,48 +2476,52 @@ dj_s64 djReadS64(dj_read_context* Context) {
   assert(Context->ShouldReadValueNext);
   Context->ShouldReadValueNext = 0;
   
+  if (Context->Format != djFORMAT_JSON)
+    return _djBinaryReadNumber(Context, 0, 0);
+  
   const char* CurrentChar = Context->CurrentChar;
   dj_s64 Value = 0;
   
-  int IsNegative = *CurrentChar == '-';
+  int IsNegative = _djPeekChar(Context, CurrentChar) == '-';
   if (IsNegative) ++CurrentChar;
   
-  if (*CurrentChar < '0' || *CurrentChar > '9') {
+  if (!_djIsDigitAt(Context, CurrentChar)) {
     djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar, Context->CurrentChar + 1, 
                                      "Expected a integer, needs to start with a digit (0-9). ");
     return 0;
   }
   
-  while (*CurrentChar >= '0' && *CurrentChar <= '9')  {
+  while (_djIsDigitAt(Context, CurrentChar))  {
     Value = Value * 10 + (*CurrentChar - '0');
     CurrentChar += 1;
   }
   
-  if (*CurrentChar == '.') {
+  if (_djPeekChar(Context, CurrentChar) == '.') {
     djReadReportErrorIfNoErrorExists(Context, CurrentChar, CurrentChar + 1, 
                                      "Expected a integer but got a decimal point. ");
     return 0;
   }
   
-  if (*CurrentChar == 'e' || *CurrentChar == 'E') {
+  if ((_djPeekChar(Context, CurrentChar) | 0x20) == 'e') {
     CurrentChar += 1;
-    if (*CurrentChar == '-') {
+    if (_djPeekChar(Context, CurrentChar) == '-') {
       djReadReportErrorIfNoErrorExists(Context, CurrentChar, CurrentChar + 1, 
                                        "Expected a integer, negative exponent is not allowed for integers. ");
       return 0;
-    } else if (*CurrentChar == '+') {
+    } else if (_djPeekChar(Context, CurrentChar) == '+') {
       CurrentChar += 1;
     }
     
-    if (*CurrentChar < '0' || *CurrentChar > '9') {
+    if (!_djIsDigitAt(Context, CurrentChar)) {
       djReadReportErrorIfNoErrorExists(Context, CurrentChar, CurrentChar + 1, 
                                        "The exponent needs to contain atleast one digit (0-9). ");
       return 0;
     }
     
     unsigned Exponent = 0;
+    _DJ_STAT_ADD(Context, NumbersSlow, 1);
     
-    while (*CurrentChar >= '0' && *CurrentChar <= '9')  {
+    while (_djIsDigitAt(Context, CurrentChar))  {
       Exponent = Exponent * 10 + (*CurrentChar - '0');
       ++CurrentChar;
     }
@@ -874,6 +2533,8 @@ dj_s64 djReadS64(dj_read_context* Context) {
       Exponent /= 2;
       Base *= Base;
     }
+  } else {
+    _DJ_STAT_ADD(Context, NumbersFast, 1);
   }
   
   Context->CurrentChar = CurrentChar;
@@ -881,86 +2542,339 @@ dj_s64 djReadS64(dj_read_context* Context) {
   return IsNegative ? -Value : Value;
 }
 
-dj_f64 djReadF64(dj_read_context* Context) {
-  assert(Context->ShouldReadValueNext);
-  Context->ShouldReadValueNext = 0;
-  
+// Checks the grammar of the number at the current char, the span of each part is returned for the caller to convert.
+typedef struct {
+  int IsNegative;
+  const char* Integer;
+  int IntegerDigits;
+  const char* Fraction;
+  int FractionDigits; // 0 if there is no fraction
+  int HasExponent;
+  int Exponent; // Clamped to +-100000, any larger exponent overflows (or only drops digits) anyway
+  const char* End;
+} _dj_number_scan;
+
+static int _djScanNumber(dj_read_context* Context, _dj_number_scan* Scan) {
   const char* CurrentChar = Context->CurrentChar;
+  memset(Scan, 0, sizeof(*Scan));
   
-  if (*CurrentChar == '-') {
+  Scan->IsNegative = _djPeekChar(Context, CurrentChar) == '-';
+  if (Scan->IsNegative) {
     CurrentChar += 1;
   }
   
-  if (*CurrentChar < '0' || *CurrentChar > '9') {
+  if (!_djIsDigitAt(Context, CurrentChar)) {
     djReadReportErrorIfNoErrorExists(Context, CurrentChar, CurrentChar + 1, 
                                      "Expected a number, needs to start with a digit (0-9). ");
     return 0;
   }
   
-  while (*CurrentChar >= '0' && *CurrentChar <= '9')  {
+  Scan->Integer = CurrentChar;
+  while (_djIsDigitAt(Context, CurrentChar))  {
     CurrentChar += 1;
   }
+  Scan->IntegerDigits = (int)(CurrentChar - Scan->Integer);
+  Scan->Fraction = CurrentChar;
   
-  if (*CurrentChar == '.') {
+  if (_djPeekChar(Context, CurrentChar) == '.') {
     CurrentChar += 1;
+    Scan->Fraction = CurrentChar;
     
-    if (*CurrentChar < '0' || *CurrentChar > '9') {
+    if (!_djIsDigitAt(Context, CurrentChar)) {
       djReadReportErrorIfNoErrorExists(Context, CurrentChar, CurrentChar + 1, 
                                        "Fraction is empty, needs to contain atleast one digit (0-9). ");
       return 0;
     }
     
-    while (*CurrentChar >= '0' && *CurrentChar <= '9')  {
+    while (_djIsDigitAt(Context, CurrentChar))  {
       CurrentChar += 1;
     }
+    Scan->FractionDigits = (int)(CurrentChar - Scan->Fraction);
   }
   
-  if (*CurrentChar == 'e' || *CurrentChar == 'E') {
+  if ((_djPeekChar(Context, CurrentChar) | 0x20) == 'e') {
     CurrentChar += 1;
-    if (*CurrentChar == '-' || *CurrentChar == '+') {
+    Scan->HasExponent = 1;
+    int IsExponentNegative = _djPeekChar(Context, CurrentChar) == '-';
+    if (IsExponentNegative || _djPeekChar(Context, CurrentChar) == '+') {
       CurrentChar += 1;
     }
     
-    if (*CurrentChar < '0' || *CurrentChar > '9') {
+    if (!_djIsDigitAt(Context, CurrentChar)) {
       djReadReportErrorIfNoErrorExists(Context, CurrentChar, CurrentChar + 1, 
                                        "Exponent is empty, needs to contain atleast one digit (0-9). ");
       return 0;
     }
     
-    while (*CurrentChar >= '0' && *CurrentChar <= '9')  {
+    while (_djIsDigitAt(Context, CurrentChar))  {
+      if (Scan->Exponent < 100000)
+        Scan->Exponent = Scan->Exponent * 10 + (*CurrentChar - '0');
       ++CurrentChar;
     }
+    if (IsExponentNegative)
+      Scan->Exponent = -Scan->Exponent;
+  }
+  
+  Scan->End = CurrentChar;
+  return 1;
+}
+
+dj_f64 djReadF64(dj_read_context* Context) {
+  assert(Context->ShouldReadValueNext);
+  Context->ShouldReadValueNext = 0;
+  
+  if (Context->Format != djFORMAT_JSON) {
+    dj_f64 Result = 0;
+    _djBinaryReadNumber(Context, 1, &Result);
+    return Result;
   }
   
-  char* EndPtr;
-  dj_f64 Result = strtod(Context->CurrentChar, &EndPtr); 
-  assert(EndPtr == CurrentChar); // TODO: Look up if this is valid, for now keep it to test. 
+  _dj_number_scan Scan;
+  if (!_djScanNumber(Context, &Scan))
+    return 0;
+  const char* CurrentChar = Scan.End;
+  
+  _DJ_STAT_ADD(Context, NumbersSlow, 1);
+  // strtod is only given the scanned number from a terminated copy, it accepts more than json (e.g. hex floats)
+  // and buffers from djReadFromBuffer aren't terminated
+  size_t Length = CurrentChar - Context->CurrentChar;
+  char LocalCopy[64];
+  char* Copy = Length < sizeof(LocalCopy) ? LocalCopy : malloc(Length + 1);
+  assert(Copy && "JSON: Out of memory. ");
+  memcpy(Copy, Context->CurrentChar, Length);
+  Copy[Length] = '\0';
+  dj_f64 Result = strtod(Copy, 0);
+  if (Copy != LocalCopy)
+    free(Copy);
   Context->CurrentChar = CurrentChar;
   _djEatWhiteSpaces(Context);
   return Result;
 }
 
-dj_string djReadString(dj_read_context* Context) {
+static const dj_s64 _dj_Powers_Of_Ten[] = {
+  1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL, 1000000000LL, 10000000000LL, 
+  100000000000LL, 1000000000000LL, 10000000000000LL, 100000000000000LL, 1000000000000000LL, 10000000000000000LL,
+  100000000000000000LL, 1000000000000000000LL
+};
+
+static dj_s64 _djBinaryReadDecimal(dj_read_context* Context, int Scale) {
+  dj_f64 Float;
+  dj_s64 Integer = _djBinaryReadNumber(Context, 1, &Float);
+  dj_s64 Power = _dj_Powers_Of_Ten[Scale];
+  
+  if (Float != (dj_f64)Integer) {
+    // Floats are already inexact, so they are rounded to the nearest value of the scale
+    dj_f64 Scaled = Float * (dj_f64)Power;
+    if (!(Scaled > -9.2e18 && Scaled < 9.2e18)) {
+      _djBinaryReportError(Context, "The number doesn't fit in 64 bits with the given scale. ");
+      return 0;
+    }
+    return (dj_s64)(Scaled < 0 ? Scaled - 0.5 : Scaled + 0.5);
+  }
+  
+  if (Integer > INT64_MAX / Power || Integer < INT64_MIN / Power) {
+    _djBinaryReportError(Context, "The number doesn't fit in 64 bits with the given scale. ");
+    return 0;
+  }
+  return Integer * Power;
+}
+
+dj_s64 djReadDecimal(dj_read_context* Context, int Scale) {
   assert(Context->ShouldReadValueNext);
+  assert(Scale >= 0 && Scale <= 18 && "The scale needs to be between 0 and 18. ");
   Context->ShouldReadValueNext = 0;
   
-  const dj_string ErrorResult = { 0, "" };
-  const char* CurrentChar = Context->CurrentChar;
-  int Length = 0;
+  if (Context->Format != djFORMAT_JSON)
+    return _djBinaryReadDecimal(Context, Scale);
   
-  if (*CurrentChar != '"') {
-    djReadReportErrorIfNoErrorExists(Context, CurrentChar, CurrentChar + 1,
-                                     "Expected a string. ", Context->LineNumber);
-    return ErrorResult;
-  }
-  CurrentChar += 1;
+  _dj_number_scan Scan;
+  if (!_djScanNumber(Context, &Scan))
+    return 0;
+  const char* CurrentChar = Scan.End;
+  int IntegerDigits = Scan.IntegerDigits, FractionDigits = Scan.FractionDigits;
   
-  int Char;
-  while (Char = *CurrentChar) {
-    if (Char == '"') {
-      break;
+  // The digits are accumulated as an integer, the ones that would end up after the decimal point once scaled has 
+  // to be zero and if there are too few the value is multiplied by 10 for each.
+  int KeptDigits = IntegerDigits + Scan.Exponent + Scale;
+  uint64_t Limit = Scan.IsNegative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+  uint64_t Value = 0;
+  for (int Index = 0; Index < IntegerDigits + FractionDigits; Index++) {
+    int Digit = (Index < IntegerDigits ? Scan.Integer[Index] : Scan.Fraction[Index - IntegerDigits]) - '0';
+    if (Index >= KeptDigits) {
+      if (Digit) {
+        djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar, CurrentChar, 
+                                         "The number has more decimals than the scale allows. ");
+        return 0;
+      }
+    } else if (Value > (Limit - Digit) / 10) {
+      djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar, CurrentChar, 
+                                       "The number doesn't fit in 64 bits with the given scale. ");
+      return 0;
+    } else {
+      Value = Value * 10 + Digit;
+    }
+  }
+  for (int Index = IntegerDigits + FractionDigits; Index < KeptDigits && Value; Index++) {
+    if (Value > Limit / 10) {
+      djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar, CurrentChar, 
+                                       "The number doesn't fit in 64 bits with the given scale. ");
+      return 0;
+    }
+    Value *= 10;
+  }
+  
+  _DJ_STAT_ADD(Context, NumbersFast, 1);
+  Context->CurrentChar = CurrentChar;
+  _djEatWhiteSpaces(Context);
+  return Scan.IsNegative ? (dj_s64)(0 - Value) : (dj_s64)Value;
+}
+
+// Binary numbers are formatted into the string buffer so they can be handled the same way as JSON numbers.
+static dj_number _djBinaryReadNumberRaw(dj_read_context* Context) {
+  dj_number Number = { 0 };
+  dj_f64 Float;
+  dj_s64 Integer = _djBinaryReadNumber(Context, 1, &Float);
+  if (Context->Error)
+    return Number;
+  if (Float - Float != 0) {
+    // Infinity - Infinity and anything with NaN is NaN, neither can be written as a json number
+    _djBinaryReportError(Context, "The number is infinite or NaN which json numbers can't represent. ");
+    return Number;
+  }
+  
+  int Length;
+  if (Float == (dj_f64)Integer)
+    Length = snprintf(Context->StringBuffer, Context->StringBufferSize, "%lld", Integer);
+  else
+    Length = snprintf(Context->StringBuffer, Context->StringBufferSize, "%.17g", Float);
+  Number.Text.Data   = Context->StringBuffer;
+  Number.Text.Length = Length;
+  
+  for (int Index = 0; Index < Length; Index++) {
+    char Char = Context->StringBuffer[Index];
+    if (Char == '-' && !Index) {
+      Number.IsNegative = 1;
+    } else if (Char == '.') {
+      Number.Flags |= djNUMBER_FRACTION;
+    } else if (Char == 'e') {
+      Number.Flags |= djNUMBER_EXPONENT;
+      break;
+    } else if (Char != '0' || Number.Digits) {
+      Number.Digits += 1;
+    }
+  }
+  return Number;
+}
+
+dj_number djReadNumberRaw(dj_read_context* Context) {
+  assert(Context->ShouldReadValueNext);
+  Context->ShouldReadValueNext = 0;
+  
+  if (Context->Format != djFORMAT_JSON)
+    return _djBinaryReadNumberRaw(Context);
+  
+  dj_number Number = { 0 };
+  _dj_number_scan Scan;
+  if (!_djScanNumber(Context, &Scan))
+    return Number;
+  
+  Number.Text.Data   = Context->CurrentChar;
+  Number.Text.Length = Scan.End - Context->CurrentChar;
+  Number.Flags       = (Scan.FractionDigits ? djNUMBER_FRACTION : 0) | (Scan.HasExponent ? djNUMBER_EXPONENT : 0);
+  Number.IsNegative  = Scan.IsNegative;
+  
+  // Leading zeros aren't significant, they can continue into the fraction e.g. "0.001"
+  int LeadingZeros = 0;
+  while (LeadingZeros < Scan.IntegerDigits + Scan.FractionDigits && 
+         (LeadingZeros < Scan.IntegerDigits ? Scan.Integer[LeadingZeros] : 
+                                              Scan.Fraction[LeadingZeros - Scan.IntegerDigits]) == '0') {
+    LeadingZeros += 1;
+  }
+  Number.Digits = Scan.IntegerDigits + Scan.FractionDigits - LeadingZeros;
+  
+  Context->CurrentChar = Scan.End;
+  _djEatWhiteSpaces(Context);
+  return Number;
+}
+
+// Reads the 4 hex digits of a \u escape, returns 0 and reports an error if any of them isn't a hex digit.
+static int _djReadHexDigits(dj_read_context* Context, const char* Digits, unsigned int* ValueOut) {
+  unsigned int Value = 0;
+  for (int Digit = 0; Digit < 4; Digit++) {
+    int Char = _djPeekChar(Context, Digits + Digit);
+    Value = Value << 4;
+    if (Char >= '0' && Char <= '9')
+      Value |= Char - '0';
+    else if (Char >= 'a' && Char <= 'f')
+      Value |= Char - 'a' + 10;
+    else if (Char >= 'A' && Char <= 'F')
+      Value |= Char - 'A' + 10;
+    else {
+      djReadReportErrorIfNoErrorExists(Context, Digits + Digit, Digits + Digit + 1,
+                                       "A unicode escape sequence needs to be followed by 4 hex digits. ");
+      return 0;
+    }
+  }
+  *ValueOut = Value;
+  return 1;
+}
+
+dj_string djReadString(dj_read_context* Context) {
+  assert(Context->ShouldReadValueNext);
+  Context->ShouldReadValueNext = 0;
+  _DJ_STAT_ADD(Context, StringsRead, 1);
+  
+  if (Context->Format != djFORMAT_JSON)
+    return _djBinaryReadString(Context);
+  
+  const dj_string ErrorResult = { 0, "" };
+  const char* CurrentChar = Context->CurrentChar;
+  int Length = 0;
+  
+  if (_djPeekChar(Context, CurrentChar) != '"') {
+    djReadReportErrorIfNoErrorExists(Context, CurrentChar, CurrentChar + 1,
+                                     "Expected a string. ");
+    return ErrorResult;
+  }
+  CurrentChar += 1;
+  
+  int Char;
+  while (1) {
+    // Runs of characters that doesn't need to be unescaped (or validated) are copied in bulk
+    const char* RunStart = CurrentChar;
+#ifdef _DJ_SSE2
+    const __m128i Quote     = _mm_set1_epi8('"');
+    const __m128i Backslash = _mm_set1_epi8('\\');
+    const __m128i Control   = _mm_set1_epi8(0x1F);
+    while (Context->EndOfData - CurrentChar >= 16) {
+      __m128i Bytes = _mm_loadu_si128((const __m128i*)CurrentChar);
+      __m128i Special = _mm_or_si128(_mm_cmpeq_epi8(Bytes, Quote), _mm_cmpeq_epi8(Bytes, Backslash));
+      Special = _mm_or_si128(Special, _mm_cmpeq_epi8(_mm_max_epu8(Bytes, Control), Control));
+      unsigned int Mask = (unsigned int)_mm_movemask_epi8(Special);
+#ifdef DIR_JSON_VALIDATE_UTF8
+      Mask |= (unsigned int)_mm_movemask_epi8(Bytes);
+#endif
+      if (Mask) {
+        CurrentChar += _djCountTrailingZeros(Mask);
+        break;
+      }
+      CurrentChar += 16;
+    }
+#endif
+    while ((Char = (unsigned char)_djPeekChar(Context, CurrentChar)) >= 0x20 && Char != '"' && Char != '\\') {
+#ifdef DIR_JSON_VALIDATE_UTF8
+      if (Char >= 0x80)
+        break;
+#endif
+      CurrentChar += 1;
+    }
+    Length = _djPutBytesInBuffer(Context, Length, RunStart, (int)(CurrentChar - RunStart));
+    
+    if (Char == '"' || Char == '\0') {
+      break;
     } else if (Char == '\\') {
-      Char = *(++CurrentChar);
+      _DJ_STAT_ADD(Context, EscapesDecoded, 1);
+      Char = _djPeekChar(Context, ++CurrentChar);
       if (Char == '"') {
         Char = '"';
       } else if (Char == '\\') {
@@ -978,46 +2892,33 @@ dj_string djReadString(dj_read_context* Context) {
       } else if (Char == 't') {
         Char = '\t';
       } else if (Char == 'u') {
-        ++CurrentChar;
-        unsigned int Value = 0;
-        for (int Digit = 0; Digit < 4; Digit++) {
-          Char = *CurrentChar;
-          Value = Value << 4;
-          if (Char >= '0' && Char <= '9')
-            Value |= Char - '0';
-          else if (Char >= 'a' && Char <= 'f')
-            Value |= Char - 'a';
-          else if (Char >= 'A' && Char <= 'F')
-            Value |= Char - 'A';
-          else {
-            djReadReportErrorIfNoErrorExists(Context, CurrentChar, CurrentChar + 1,
-                                             "A unicode escape sequence needs to be followed by 4 hex digits. ");
-            return ErrorResult;
-          }
-          ++CurrentChar;
-        }
+        const char* Escape = CurrentChar - 1;
+        unsigned int Value;
+        if (!_djReadHexDigits(Context, CurrentChar + 1, &Value))
+          return ErrorResult;
+        CurrentChar += 5;
         
-        if (Value >= 0x1000) {
-          if (Value >= 0x2000) {
-            djReadReportErrorIfNoErrorExists(Context,CurrentChar - 4, CurrentChar,
-                                             "Given unicode was to large. ");
+        if (Value >= 0xD800 && Value <= 0xDBFF) {
+          // A high surrogate, it and the low surrogate that has to follow encodes a code point above U+FFFF
+          unsigned int Low = 0;
+          if (_djPeekChar(Context, CurrentChar) == '\\' && _djPeekChar(Context, CurrentChar + 1) == 'u') {
+            if (!_djReadHexDigits(Context, CurrentChar + 2, &Low))
+              return ErrorResult;
+          }
+          if (Low < 0xDC00 || Low > 0xDFFF) {
+            djReadReportErrorIfNoErrorExists(Context, Escape, CurrentChar,
+                                             "A high surrogate needs to be followed by a low surrogate. ");
             return ErrorResult;
           }
-          
-          Length = _djPutCharInBuffer(Context, Length, 0x80 | ((Char >> 0 ) & 0x3F));
-          Length = _djPutCharInBuffer(Context, Length, 0x80 | ((Char >> 6 ) & 0x3F));
-          Length = _djPutCharInBuffer(Context, Length, 0x80 | ((Char >> 12) & 0x3F));
-          Length = _djPutCharInBuffer(Context, Length, 0xF0 | ((Char >> 18) & 0x07));
-        } else if (Value >= 0x800) {
-          Length = _djPutCharInBuffer(Context, Length, 0x80 | ((Char >> 0 ) & 0x3F));
-          Length = _djPutCharInBuffer(Context, Length, 0x80 | ((Char >> 6 ) & 0x3F));
-          Length = _djPutCharInBuffer(Context, Length, 0xE0 | ((Char >> 12) & 0x0F));
-        } else if (Value >= 0x80) {
-          Length = _djPutCharInBuffer(Context, Length, 0x80 | ((Char >> 0) & 0x3F));
-          Length = _djPutCharInBuffer(Context, Length, 0xC0 | ((Char >> 6) & 0x1F));
-        } else {
-          Length = _djPutCharInBuffer(Context, Length, Char);
+          CurrentChar += 6;
+          Value = 0x10000 + ((Value - 0xD800) << 10) + (Low - 0xDC00);
+        } else if (Value >= 0xDC00 && Value <= 0xDFFF) {
+          djReadReportErrorIfNoErrorExists(Context, Escape, CurrentChar,
+                                           "A low surrogate needs to be preceded by a high surrogate. ");
+          return ErrorResult;
         }
+        
+        Length = _djPutCodePointInBuffer(Context, Length, Value);
         continue;
       } else {
         djReadReportErrorIfNoErrorExists(Context, CurrentChar, CurrentChar + 1,
@@ -1028,6 +2929,18 @@ dj_string djReadString(dj_read_context* Context) {
       djReadReportErrorIfNoErrorExists(Context, CurrentChar, CurrentChar + 1,
                                        "Reached end of the line before closing the string. ");
       return ErrorResult;
+#ifdef DIR_JSON_VALIDATE_UTF8
+    } else if (Char >= 0x80) {
+      int SequenceLength = _djValidateUtf8((const unsigned char*)CurrentChar, (const unsigned char*)Context->EndOfData);
+      if (!SequenceLength) {
+        djReadReportErrorIfNoErrorExists(Context, CurrentChar, CurrentChar + 1,
+                                         "Invalid UTF-8 in string. ");
+        return ErrorResult;
+      }
+      Length = _djPutBytesInBuffer(Context, Length, CurrentChar, SequenceLength);
+      CurrentChar += SequenceLength;
+      continue;
+#endif
     }
     
     Length = _djPutCharInBuffer(Context, Length, Char);
@@ -1044,11 +2957,11 @@ dj_string djReadString(dj_read_context* Context) {
   Context->CurrentChar = CurrentChar;
   _djEatWhiteSpaces(Context);
   
-  Length = _djPutCharInBuffer(Context, Length, '\0');
-  
   dj_string Result;
-  Result.Data = Context->StringBuffer;
   Result.Length = Length;
+  
+  Length = _djPutCharInBuffer(Context, Length, '\0');
+  Result.Data = Context->StringBuffer;
   return Result;
 }
 
@@ -1056,207 +2969,2454 @@ void djReadNull(dj_read_context* Context) {
   assert(Context->ShouldReadValueNext);
   Context->ShouldReadValueNext = 0;
   
+  if (Context->Format != djFORMAT_JSON) {
+    _dj_binary_head Head;
+    _djBinaryReadHead(Context, &Head, _dj_Binary_Null, "Expected 'null'. ");
+    return;
+  }
+  
   static const char NULL_STR[]  = "null";
-  if (memcmp(Context->CurrentChar, NULL_STR, sizeof(NULL_STR) - 1) == 0) {
+  if ((size_t)(Context->EndOfData - Context->CurrentChar) >= sizeof(NULL_STR) - 1 && 
+      memcmp(Context->CurrentChar, NULL_STR, sizeof(NULL_STR) - 1) == 0) {
     Context->CurrentChar += sizeof(NULL_STR) - 1;
   } else {
     djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar, Context->CurrentChar + 1, 
-                                     "Expected 'null'. ", Context->LineNumber);
+                                     "Expected 'null'. ");
   }
   _djEatWhiteSpaces(Context);
 }
 
 void djReadEOF(dj_read_context* Context) {
-  if (*Context->CurrentChar != '\0') {
+  if (Context->Format != djFORMAT_JSON) {
+    if (Context->CurrentChar != Context->EndOfData)
+      _djBinaryReportError(Context, "Unexpected content at end of file. ");
+    return;
+  }
+  
+  if (_djPeekChar(Context, Context->CurrentChar) != '\0') {
     djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar, Context->CurrentChar + 1, 
                                      "Unexpected content at end of file. ");
   }
 }
 
 int djReadNextIsObject(dj_read_context* Context) { 
-  return *Context->CurrentChar == '{';  
+  if (Context->Format != djFORMAT_JSON)
+    return _djBinaryNextIs(Context, _dj_Binary_Object);
+  return _djPeekChar(Context, Context->CurrentChar) == '{';  
 }
 
 int djReadNextIsArray( dj_read_context* Context) { 
-  return *Context->CurrentChar == '[';  
+  if (Context->Format != djFORMAT_JSON)
+    return _djBinaryNextIs(Context, _dj_Binary_Array);
+  return _djPeekChar(Context, Context->CurrentChar) == '[';  
 }
 
 int djReadNextIsBool(  dj_read_context* Context) { 
-  return *Context->CurrentChar == 't' || *Context->CurrentChar == 'f';  
+  if (Context->Format != djFORMAT_JSON)
+    return _djBinaryNextIs(Context, _dj_Binary_Bool);
+  char Char = _djPeekChar(Context, Context->CurrentChar);
+  return Char == 't' || Char == 'f';  
 }
 
 int djReadNextIsNumber(dj_read_context* Context) { 
-  return (*Context->CurrentChar >= '0' && *Context->CurrentChar <= '9') || 
-    *Context->CurrentChar == '-';  
+  if (Context->Format != djFORMAT_JSON)
+    return _djBinaryNextIs(Context, _dj_Binary_Integer) || _djBinaryNextIs(Context, _dj_Binary_Float);
+  char Char = _djPeekChar(Context, Context->CurrentChar);
+  return (Char >= '0' && Char <= '9') || Char == '-';  
 }
 
 int djReadNextIsString(dj_read_context* Context) { 
-  return *Context->CurrentChar == '"';  
+  if (Context->Format != djFORMAT_JSON)
+    return _djBinaryNextIs(Context, _dj_Binary_String);
+  return _djPeekChar(Context, Context->CurrentChar) == '"';  
 }
 
 int djReadNextIsNull(  dj_read_context* Context) { 
-  return *Context->CurrentChar == 'n';  
+  if (Context->Format != djFORMAT_JSON)
+    return _djBinaryNextIs(Context, _dj_Binary_Null);
+  return _djPeekChar(Context, Context->CurrentChar) == 'n';  
+}
+
+// Scans past the structure starting at CurrentChar until Depth reaches zero, returns 0 if an error occured.
+// With a Depth of 0 a single value is scanned, with a Depth of 1 the rest of the current container is scanned.
+static const char* _djScanStructure(dj_read_context* Context, const char* CurrentChar, int Depth) {
+  do {
+    char Char = _djPeekChar(Context, CurrentChar);
+    if (Char == '"') {
+      CurrentChar += 1;
+      while (1) {
+        CurrentChar = _djFindQuoteOrBackslash(CurrentChar, Context->EndOfData);
+        Char = _djPeekChar(Context, CurrentChar);
+        if (!Char || Char == '"')
+          break;
+        if (Char == '\\' && _djPeekChar(Context, CurrentChar + 1))
+          CurrentChar += 1;
+        CurrentChar += 1;
+      }
+      if (!Char) {
+        djReadReportErrorIfNoErrorExists(Context, CurrentChar, CurrentChar + 1,
+                                         "Reached end of the file before closing the string. ");
+        return 0;
+      }
+      CurrentChar += 1;
+    } else if (Char == '{' || Char == '[') {
+      Depth += 1;
+      CurrentChar += 1;
+    } else if (Char == '}' || Char == ']') {
+      if (Depth == 0) {
+        djReadReportErrorIfNoErrorExists(Context, CurrentChar, CurrentChar + 1, "Expected a value. ");
+        return 0;
+      }
+      Depth -= 1;
+      CurrentChar += 1;
+    } else if (Char == '\0') {
+      djReadReportErrorIfNoErrorExists(Context, CurrentChar, CurrentChar + 1,
+                                       "Reached end of the file before the end of the value. ");
+      return 0;
+    } else if (Depth > 0) {
+      CurrentChar += 1;
+    } else {
+      const char* Start = CurrentChar;
+      while ((Char = _djPeekChar(Context, CurrentChar)) && !strchr(",:]} \t\r\n", Char))
+        CurrentChar += 1;
+      if (CurrentChar == Start) {
+        djReadReportErrorIfNoErrorExists(Context, CurrentChar, CurrentChar + 1, "Expected a value. ");
+        return 0;
+      }
+    }
+  } while (Depth > 0);
+  
+  return CurrentChar;
+}
+
+void djReadSkipValue(dj_read_context* Context) {
+  assert(Context->ShouldReadValueNext);
+  Context->ShouldReadValueNext = 0;
+  
+  if (Context->Format != djFORMAT_JSON) {
+    _djBinarySkipValue(Context, 0);
+    return;
+  }
+  
+  const char* CurrentChar = _djScanStructure(Context, Context->CurrentChar, 0);
+  if (CurrentChar) {
+    Context->CurrentChar = CurrentChar;
+    _djEatWhiteSpaces(Context);
+  }
+}
+
+// Skips the remaining members of the object or array that is being read, as if djReadKey or djReadArray had 
+// been called until they returned 0. Needs to be called after a member value has been read.
+static void _djReadSkipRest(dj_read_context* Context, int IsObject) {
+  assert(!Context->ShouldReadValueNext);
+  if (Context->Error)
+    return;
+  
+  if (Context->Format != djFORMAT_JSON) {
+    while (_djBinaryNextMember(Context, IsObject)) {
+      if (IsObject)
+        _djBinarySkipValue(Context, 0);
+      _djBinarySkipValue(Context, 0);
+    }
+    return;
+  }
+  
+  const char* CurrentChar = _djScanStructure(Context, Context->CurrentChar, 1);
+  if (CurrentChar) {
+    Context->CurrentChar = CurrentChar;
+    _djEatWhiteSpaces(Context);
+    _DJ_PROFILE_EXIT(Context);
+  }
+}
+
+// Compares a key against a JSON Pointer reference token, unescaping '~0' and '~1' in the token on the fly.
+static int _djPointerTokenEquals(dj_string Key, dj_string Token) {
+  size_t KeyIndex = 0;
+  for (size_t TokenIndex = 0; TokenIndex < Token.Length; TokenIndex++) {
+    char Char = Token.Data[TokenIndex];
+    if (Char == '~' && TokenIndex + 1 < Token.Length) {
+      if (Token.Data[TokenIndex + 1] == '0') {
+        Char = '~';
+        TokenIndex += 1;
+      } else if (Token.Data[TokenIndex + 1] == '1') {
+        Char = '/';
+        TokenIndex += 1;
+      }
+    }
+    
+    if (KeyIndex == Key.Length || Key.Data[KeyIndex] != Char)
+      return 0;
+    KeyIndex += 1;
+  }
+  return KeyIndex == Key.Length;
+}
+
+// Returns the array index of the token, or -1 if it isn't a valid index.
+static dj_s64 _djPointerTokenIndex(dj_string Token) {
+  if (Token.Length == 0 || (Token.Length > 1 && Token.Data[0] == '0') || Token.Length > 18)
+    return -1;
+  
+  dj_s64 Index = 0;
+  for (size_t CharIndex = 0; CharIndex < Token.Length; CharIndex++) {
+    if (Token.Data[CharIndex] < '0' || Token.Data[CharIndex] > '9')
+      return -1;
+    Index = Index * 10 + (Token.Data[CharIndex] - '0');
+  }
+  return Index;
+}
+
+int djReadSeekPath(dj_read_context* Context, const char* Path) {
+  assert(Context->ShouldReadValueNext);
+  assert((*Path == '\0' || *Path == '/') && "A JSON Pointer needs to be empty or start with '/'. ");
+  
+  while (*Path == '/' && !Context->Error) {
+    dj_string Token;
+    Token.Data = Path + 1;
+    Path = Token.Data;
+    while (*Path && *Path != '/')
+      Path += 1;
+    Token.Length = Path - Token.Data;
+    
+    int Found = 0;
+    if (djReadNextIsObject(Context)) {
+      dj_string Key;
+      int HasEscapes;
+      while (!Found && _djReadRawKey(Context, &Key, &HasEscapes)) {
+        if (HasEscapes)
+          Key = _djUnescapeRawString(Context, Key);
+        
+        if (_djPointerTokenEquals(Key, Token)) {
+          Found = 1;
+        } else {
+          djReadSkipValue(Context);
+        }
+      }
+    } else if (djReadNextIsArray(Context)) {
+      dj_s64 Index = _djPointerTokenIndex(Token);
+      if (Index < 0) {
+        djReadSkipValue(Context);
+      } else {
+        while (!Found && djReadArray(Context)) {
+          if (Index-- == 0) {
+            Found = 1;
+          } else {
+            djReadSkipValue(Context);
+          }
+        }
+      }
+    }
+    
+    if (!Found)
+      return 0;
+  }
+  
+  return !Context->Error;
 }
 
 // ===============================================================================
-// Write Implementation
+// Columns Implementation
 // ===============================================================================
 
-const char _dj_Spaces_Array[]= "                                                             ";
-enum {
-  _dj_Context_Clue_First_Item,
-  _dj_Context_Clue_Member_Value,
-  _dj_Context_Clue_Write_Comma
-};
+dj_columns_object* djInitializeColumns(dj_column_member* Members, int MemberCount) {
+  int SlotsCount = (MemberCount * 10) / 8 + 1;
+  size_t StringsByteCount = 0;
+  for (int MemberIndex = 0; MemberIndex < MemberCount; MemberIndex++) {
+    assert(Members[MemberIndex].Key && "Key can't be null. ");
+    assert(Members[MemberIndex].Type >= djCOLUMN_S64 && Members[MemberIndex].Type <= djCOLUMN_STRING);
+    StringsByteCount += strlen(Members[MemberIndex].Key) + 1;
+  }
+  
+  size_t TotalBytes = sizeof(dj_columns_object);
+  TotalBytes += sizeof(_dj_column) * MemberCount;
+  TotalBytes += sizeof(int)        * SlotsCount * 2;
+  TotalBytes += StringsByteCount;
+  
+  dj_columns_object* Result = calloc(TotalBytes, 1);
+  assert(Result && "JSON: Out of memory. ");
+  Result->SlotsCount  = SlotsCount;
+  Result->ColumnCount = MemberCount;
+  Result->Columns     = (_dj_column*)((char*)Result + sizeof(dj_columns_object));
+  Result->ColumnKeys  = (int*)&Result->Columns[MemberCount];
+  Result->SlotColumns = &Result->ColumnKeys[SlotsCount];
+  
+  char* StringCopyCurrentChar = (char*)&Result->SlotColumns[SlotsCount];
+  
+  for (int MemberIndex = 0; MemberIndex < MemberCount; MemberIndex++) {
+    dj_column_member* Member = &Members[MemberIndex];
+    Result->Columns[MemberIndex].Public.Type = Member->Type;
+    
+    unsigned int Hash = _djHashString(Member->Key);
+    while (1) {
+      unsigned int Index = Hash % SlotsCount;
+      
+      if (!Result->ColumnKeys[Index]) {
+        size_t Length = strlen(Member->Key);
+        Result->ColumnKeys[Index]  = (int)(StringCopyCurrentChar - (char*)Result);
+        Result->SlotColumns[Index] = MemberIndex;
+        memcpy(StringCopyCurrentChar, Member->Key, Length + 1);
+        StringCopyCurrentChar += Length + 1;
+        break;
+      }
+      
+      Hash += 1;
+    }
+  }
+  
+  assert(StringCopyCurrentChar == ((char*)Result + TotalBytes));
+  
+  return Result;
+}
 
-static void _djFlushBuffer(dj_write_context* Context) {
-  if (Context->TargetFile) {
-    size_t AmountWritten = fwrite(Context->Buffer, 1, Context->Used, Context->TargetFile);
-    if (AmountWritten != Context->Used && !Context->Error) {
-      Context->Error = "Failed to write to file. ";
+void djDestroyColumns(dj_columns_object* Columns) {
+  for (int ColumnIndex = 0; ColumnIndex < Columns->ColumnCount; ColumnIndex++) {
+    dj_column* Column = &Columns->Columns[ColumnIndex].Public;
+    free(Column->Values);
+    free(Column->StringData);
+    free(Column->NullBits);
+    free(Column->MissingBits);
+  }
+  free(Columns);
+}
+
+void djResetColumns(dj_columns_object* Columns) {
+  Columns->RowCount = 0;
+  for (int ColumnIndex = 0; ColumnIndex < Columns->ColumnCount; ColumnIndex++) {
+    Columns->Columns[ColumnIndex].Public.Count = 0;
+  }
+}
+
+const dj_column* djGetColumn(dj_columns_object* Columns, int ColumnIndex) {
+  assert(ColumnIndex >= 0 && ColumnIndex < Columns->ColumnCount);
+  return &Columns->Columns[ColumnIndex].Public;
+}
+
+static void _djReserveColumnRows(dj_columns_object* Columns, size_t RowCount) {
+  if (RowCount <= Columns->RowCapacity)
+    return;
+  
+  size_t OldBitBytes = (Columns->RowCapacity + 7) / 8;
+  Columns->RowCapacity = Columns->RowCapacity ? Columns->RowCapacity * 2 : 256;
+  size_t NewBitBytes = (Columns->RowCapacity + 7) / 8;
+  
+  for (int ColumnIndex = 0; ColumnIndex < Columns->ColumnCount; ColumnIndex++) {
+    dj_column* Column = &Columns->Columns[ColumnIndex].Public;
+    
+    size_t ValueSize;
+    switch (Column->Type) {
+      case djCOLUMN_S64:    ValueSize = sizeof(dj_s64); break;
+      case djCOLUMN_F64:    ValueSize = sizeof(dj_f64); break;
+      case djCOLUMN_BOOL:   ValueSize = sizeof(char);   break;
+      case djCOLUMN_STRING: ValueSize = sizeof(size_t); break;
     }
-    Context->Used = 0;
-  } else if (Context->Callback) {
-    Context->Callback(Context, Context->Buffer, Context->Used);
-    Context->Used = 0;
+    
+    // String columns store Count + 1 offsets
+    size_t ValueCount = Columns->RowCapacity + (Column->Type == djCOLUMN_STRING);
+    int IsFirstAllocation = !Column->Values;
+    Column->Values      = realloc(Column->Values,      ValueSize * ValueCount);
+    Column->NullBits    = realloc(Column->NullBits,    NewBitBytes);
+    Column->MissingBits = realloc(Column->MissingBits, NewBitBytes);
+    assert(Column->Values && Column->NullBits && Column->MissingBits && "JSON: Out of memory. ");
+    
+    memset(Column->NullBits    + OldBitBytes, 0, NewBitBytes - OldBitBytes);
+    memset(Column->MissingBits + OldBitBytes, 0, NewBitBytes - OldBitBytes);
+    if (IsFirstAllocation && Column->Type == djCOLUMN_STRING) {
+      ((size_t*)Column->Values)[0] = 0;
+    }
+  }
+}
+
+static void _djSetColumnBit(unsigned char* Bits, size_t Index, int Value) {
+  if (Value)
+    Bits[Index / 8] |=  (unsigned char)(1 << (Index % 8));
+  else
+    Bits[Index / 8] &= ~(unsigned char)(1 << (Index % 8));
+}
+
+static void _djPushColumnString(_dj_column* Column, const char* Data, size_t Length) {
+  size_t* Offsets = (size_t*)Column->Public.Values;
+  size_t Used = Offsets[Column->Public.Count];
+  
+  if (Used + Length > Column->StringDataSize) {
+    while (Used + Length > Column->StringDataSize)
+      Column->StringDataSize = Column->StringDataSize ? Column->StringDataSize * 2 : 1024;
+    Column->Public.StringData = realloc(Column->Public.StringData, Column->StringDataSize);
+    assert(Column->Public.StringData && "JSON: Out of memory. ");
+  }
+  
+  if (Length)
+    memcpy(Column->Public.StringData + Used, Data, Length);
+  Offsets[Column->Public.Count + 1] = Used + Length;
+}
+
+// Pushes a zero value for the next row, used for null and missing values.
+static void _djPushColumnZero(_dj_column* Column) {
+  dj_column* Public = &Column->Public;
+  switch (Public->Type) {
+    case djCOLUMN_S64:    ((dj_s64*)Public->Values)[Public->Count] = 0; break;
+    case djCOLUMN_F64:    ((dj_f64*)Public->Values)[Public->Count] = 0; break;
+    case djCOLUMN_BOOL:   ((char*  )Public->Values)[Public->Count] = 0; break;
+    case djCOLUMN_STRING: _djPushColumnString(Column, 0, 0);            break;
+  }
+}
+
+static void _djReadColumnValue(dj_read_context* Context, _dj_column* Column) {
+  dj_column* Public = &Column->Public;
+  int IsNull = djReadNextIsNull(Context);
+  
+  if (IsNull) {
+    djReadNull(Context);
+    _djPushColumnZero(Column);
   } else {
-    Context->Size = max(128, Context->Size * 2);
-    Context->Buffer = realloc(Context->Buffer, Context->Size);
-    assert(Context->Buffer);
+    switch (Public->Type) {
+      case djCOLUMN_S64:  ((dj_s64*)Public->Values)[Public->Count] = djReadS64( Context); break;
+      case djCOLUMN_F64:  ((dj_f64*)Public->Values)[Public->Count] = djReadF64( Context); break;
+      case djCOLUMN_BOOL: ((char*  )Public->Values)[Public->Count] = (char)djReadBool(Context); break;
+      case djCOLUMN_STRING: {
+        dj_string String = djReadString(Context);
+        _djPushColumnString(Column, String.Data, String.Length);
+      } break;
+    }
+  }
+  
+  _djSetColumnBit(Public->NullBits,    Public->Count, IsNull);
+  _djSetColumnBit(Public->MissingBits, Public->Count, 0);
+  Public->Count += 1;
+}
+
+size_t djReadColumns(dj_read_context* Context, dj_columns_object* Columns) {
+  size_t RowCountBefore = Columns->RowCount;
+  
+  while (djReadArray(Context)) {
+    size_t Row = Columns->RowCount;
+    _djReserveColumnRows(Columns, Row + 1);
+    
+    dj_string Key;
+    while (djReadKey(Context, &Key)) {
+      int SlotIndex = _djFindSlot((const char*)Columns, Columns->ColumnKeys, Columns->SlotsCount, Key,
+                                  _DJ_STAT_PTR(Context, HashProbes));
+      if (SlotIndex < 0) {
+        djReadSkipValue(Context);
+        continue;
+      }
+      
+      _dj_column* Column = &Columns->Columns[Columns->SlotColumns[SlotIndex]];
+      if (Column->Public.Count > Row) {
+        char* KeyCopy = malloc(Key.Length + 1);
+        memcpy(KeyCopy, Key.Data, Key.Length);
+        KeyCopy[Key.Length] = '\0';
+        djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar - 1, Context->CurrentChar,
+                                         "Duplicate member encountered (Key '%s'. )", KeyCopy);
+        free(KeyCopy);
+        break;
+      }
+      _djReadColumnValue(Context, Column);
+    }
+    
+    if (djReadError(Context)) {
+      // Drop the partially read row
+      for (int ColumnIndex = 0; ColumnIndex < Columns->ColumnCount; ColumnIndex++) {
+        Columns->Columns[ColumnIndex].Public.Count = Row;
+      }
+      break;
+    }
+    
+    for (int ColumnIndex = 0; ColumnIndex < Columns->ColumnCount; ColumnIndex++) {
+      _dj_column* Column = &Columns->Columns[ColumnIndex];
+      if (Column->Public.Count == Row) {
+        _djPushColumnZero(Column);
+        _djSetColumnBit(Column->Public.NullBits,    Row, 0);
+        _djSetColumnBit(Column->Public.MissingBits, Row, 1);
+        Column->Public.Count += 1;
+      }
+    }
+    Columns->RowCount = Row + 1;
+  }
+  
+  return Columns->RowCount - RowCountBefore;
+}
+
+// ===============================================================================
+// Tape Implementation
+// ===============================================================================
+
+// Each entry has the type in the top 8 bits and a 56 bit payload. Strings, integers and floats uses two entries,
+// the second holds the length, the value or the bits of the value. Containers store the entry count of their 
+// members in bit 32-55 and the index of the entry after their end in bit 0-31. Numbers read from json store the 
+// offset of their text plus one, so they can be written again exactly as they were.
+struct dj_tape {
+  const char* Source;
+  const char* SourceEnd;
+  uint64_t* Entries;
+  size_t EntryCount, EntryCapacity;
+  char* Strings;
+  size_t StringsUsed, StringsSize;
+};
+
+#define _DJ_TAPE_PAYLOAD_MASK     0x00FFFFFFFFFFFFFFull
+#define _DJ_TAPE_STRING_IN_BUFFER (1ull << 55)
+
+enum {
+  _dj_Tape_Object_End = djTYPE_NULL + 1,
+  _dj_Tape_Array_End
+};
+
+static uint64_t _djTapeEntry(int Type, uint64_t Payload) {
+  return ((uint64_t)Type << 56) | (Payload & _DJ_TAPE_PAYLOAD_MASK);
+}
+
+static size_t _djTapePush(dj_tape* Tape, uint64_t Entry) {
+  if (Tape->EntryCount == Tape->EntryCapacity) {
+    Tape->EntryCapacity = Tape->EntryCapacity ? Tape->EntryCapacity * 2 : 256;
+    Tape->Entries = realloc(Tape->Entries, Tape->EntryCapacity * sizeof(uint64_t));
+    assert(Tape->Entries && "JSON: Out of memory. ");
+  }
+  Tape->Entries[Tape->EntryCount] = Entry;
+  return Tape->EntryCount++;
+}
+
+static void _djTapeAddString(dj_tape* Tape, dj_read_context* Context, dj_string Raw, int HasEscapes) {
+  if (!HasEscapes) {
+    _djTapePush(Tape, _djTapeEntry(djTYPE_STRING, Raw.Data - Tape->Source));
+    _djTapePush(Tape, Raw.Length);
+    return;
+  }
+  
+  dj_string String = _djUnescapeRawString(Context, Raw);
+  if (Context->Error)
+    return;
+  
+  if (Tape->StringsUsed + String.Length + 1 > Tape->StringsSize) {
+    while (Tape->StringsUsed + String.Length + 1 > Tape->StringsSize)
+      Tape->StringsSize = Tape->StringsSize ? Tape->StringsSize * 2 : 256;
+    Tape->Strings = realloc(Tape->Strings, Tape->StringsSize);
+    assert(Tape->Strings && "JSON: Out of memory. ");
+  }
+  memcpy(Tape->Strings + Tape->StringsUsed, String.Data, String.Length + 1);
+  
+  _djTapePush(Tape, _djTapeEntry(djTYPE_STRING, _DJ_TAPE_STRING_IN_BUFFER | Tape->StringsUsed));
+  _djTapePush(Tape, String.Length);
+  Tape->StringsUsed += String.Length + 1;
+}
+
+// Returns 1 if the next number has to be read with djReadF64, integers that don't fit in 64 bits are included since
+// djReadS64 would overflow on them.
+static int _djReadNextIsFloat(dj_read_context* Context) {
+  if (Context->Format != djFORMAT_JSON)
+    return _djBinaryNextIs(Context, _dj_Binary_Float);
+  
+  const char* CurrentChar = Context->CurrentChar;
+  if (_djPeekChar(Context, CurrentChar) == '-')
+    CurrentChar += 1;
+  const char* Digits = CurrentChar;
+  while (_djIsDigitAt(Context, CurrentChar))
+    CurrentChar += 1;
+  if (_djPeekChar(Context, CurrentChar) == '.' || (_djPeekChar(Context, CurrentChar) | 0x20) == 'e')
+    return 1;
+  
+  size_t DigitCount = CurrentChar - Digits;
+  return DigitCount > 19 || (DigitCount == 19 && memcmp(Digits, "9223372036854775807", 19) > 0);
+}
+
+static void _djTapeBuildValue(dj_tape* Tape, dj_read_context* Context, int Depth) {
+  if (Depth == DIR_JSON_READ_MAX_DEPTH) {
+    djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar, Context->CurrentChar + 1,
+                                     "Containers are nested too deeply. ");
+    return;
+  }
+  
+  if (djReadNextIsObject(Context) || djReadNextIsArray(Context)) {
+    int IsObject = djReadNextIsObject(Context);
+    size_t Start = _djTapePush(Tape, 0);
+    uint64_t Count = 0;
+    
+    if (IsObject) {
+      dj_string Key;
+      int HasEscapes;
+      while (_djReadRawKey(Context, &Key, &HasEscapes)) {
+        _djTapeAddString(Tape, Context, Key, HasEscapes);
+        _djTapeBuildValue(Tape, Context, Depth + 1);
+        Count += 1;
+      }
+    } else {
+      while (djReadArray(Context)) {
+        _djTapeBuildValue(Tape, Context, Depth + 1);
+        Count += 1;
+      }
+    }
+    
+    if (Context->Error)
+      return;
+    
+    // The entry of the container has 24 bits for the count and 32 bits for the index after the end
+    size_t End = _djTapePush(Tape, _djTapeEntry(IsObject ? _dj_Tape_Object_End : _dj_Tape_Array_End, Start));
+    if (Count > 0xFFFFFF || (uint64_t)End + 1 > 0xFFFFFFFF) {
+      djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar - 1, Context->CurrentChar, 
+                                       Count > 0xFFFFFF ? "The container has too many members for a tape. " :
+                                                          "The value is too large for a tape. ");
+      return;
+    }
+    Tape->Entries[Start] = _djTapeEntry(IsObject ? djTYPE_OBJECT : djTYPE_ARRAY, (Count << 32) | (End + 1));
+  } else if (djReadNextIsString(Context)) {
+    dj_string String;
+    int HasEscapes = 0;
+    if (Context->Format == djFORMAT_JSON) {
+      Context->ShouldReadValueNext = 0;
+      HasEscapes = _djReadRawString(Context, &String);
+    } else {
+      String = djReadString(Context);
+    }
+    if (!Context->Error)
+      _djTapeAddString(Tape, Context, String, HasEscapes);
+  } else if (djReadNextIsNumber(Context)) {
+    uint64_t TextOffset = Context->Format == djFORMAT_JSON ? Context->CurrentChar - Tape->Source + 1 : 0;
+    if (_djReadNextIsFloat(Context)) {
+      dj_f64 Value = djReadF64(Context);
+      uint64_t Bits;
+      memcpy(&Bits, &Value, sizeof(Bits));
+      _djTapePush(Tape, _djTapeEntry(djTYPE_F64, TextOffset));
+      _djTapePush(Tape, Bits);
+    } else {
+      _djTapePush(Tape, _djTapeEntry(djTYPE_S64, TextOffset));
+      _djTapePush(Tape, (uint64_t)djReadS64(Context));
+    }
+  } else if (djReadNextIsBool(Context)) {
+    _djTapePush(Tape, _djTapeEntry(djTYPE_BOOL, djReadBool(Context)));
+  } else if (djReadNextIsNull(Context)) {
+    djReadNull(Context);
+    _djTapePush(Tape, _djTapeEntry(djTYPE_NULL, 0));
+  } else {
+    djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar, Context->CurrentChar + 1, "Expected a value. ");
+  }
+}
+
+dj_tape* djReadTape(dj_read_context* Context) {
+  assert(Context->ShouldReadValueNext);
+  
+  dj_tape* Tape = calloc(1, sizeof(dj_tape));
+  assert(Tape && "JSON: Out of memory. ");
+  Tape->Source    = Context->JsonData;
+  Tape->SourceEnd = Context->EndOfData;
+  
+  _djTapePush(Tape, 0); // Root entry, the payload is the entry count
+  _djTapeBuildValue(Tape, Context, 0);
+  
+  if (Context->Error) {
+    djDestroyTape(Tape);
+    return 0;
+  }
+  
+  Tape->Entries[0] = _djTapeEntry(djTYPE_NONE, Tape->EntryCount);
+  return Tape;
+}
+
+void djDestroyTape(dj_tape* Tape) {
+  free(Tape->Entries);
+  free(Tape->Strings);
+  free(Tape);
+}
+
+int djTapeType(dj_tape* Tape, size_t Index) {
+  if (Index == 0 || Index >= Tape->EntryCount)
+    return djTYPE_NONE;
+  
+  int Type = (int)(Tape->Entries[Index] >> 56);
+  return Type <= djTYPE_NULL ? Type : djTYPE_NONE;
+}
+
+size_t djTapeNext(dj_tape* Tape, size_t Index) {
+  size_t Next;
+  switch (djTapeType(Tape, Index)) {
+    case djTYPE_OBJECT:
+    case djTYPE_ARRAY:  Next = (size_t)(Tape->Entries[Index] & 0xFFFFFFFF); break;
+    case djTYPE_STRING:
+    case djTYPE_S64:
+    case djTYPE_F64:    Next = Index + 2; break;
+    case djTYPE_BOOL:
+    case djTYPE_NULL:   Next = Index + 1; break;
+    default: return 0;
+  }
+  return djTapeType(Tape, Next) != djTYPE_NONE ? Next : 0;
+}
+
+size_t djTapeChild(dj_tape* Tape, size_t Index) {
+  int Type = djTapeType(Tape, Index);
+  if (Type != djTYPE_OBJECT && Type != djTYPE_ARRAY)
+    return 0;
+  return djTapeType(Tape, Index + 1) != djTYPE_NONE ? Index + 1 : 0;
+}
+
+size_t djTapeCount(dj_tape* Tape, size_t Index) {
+  int Type = djTapeType(Tape, Index);
+  if (Type != djTYPE_OBJECT && Type != djTYPE_ARRAY)
+    return 0;
+  return (size_t)((Tape->Entries[Index] >> 32) & 0xFFFFFF);
+}
+
+size_t djTapeFindKey(dj_tape* Tape, size_t ObjectIndex, const char* Key) {
+  if (djTapeType(Tape, ObjectIndex) != djTYPE_OBJECT)
+    return 0;
+  
+  for (size_t KeyIndex = djTapeChild(Tape, ObjectIndex); KeyIndex; KeyIndex = djTapeNext(Tape, KeyIndex + 2)) {
+    if (_djStringEquals(djTapeString(Tape, KeyIndex), Key))
+      return KeyIndex + 2;
+  }
+  return 0;
+}
+
+size_t djTapeElement(dj_tape* Tape, size_t ArrayIndex, size_t ElementIndex) {
+  if (djTapeType(Tape, ArrayIndex) != djTYPE_ARRAY)
+    return 0;
+  
+  size_t Index = djTapeChild(Tape, ArrayIndex);
+  while (Index && ElementIndex--) {
+    Index = djTapeNext(Tape, Index);
+  }
+  return Index;
+}
+
+int djTapeBool(dj_tape* Tape, size_t Index) {
+  if (djTapeType(Tape, Index) != djTYPE_BOOL)
+    return 0;
+  return (int)(Tape->Entries[Index] & 1);
+}
+
+dj_s64 djTapeS64(dj_tape* Tape, size_t Index) {
+  switch (djTapeType(Tape, Index)) {
+    case djTYPE_S64: return (dj_s64)Tape->Entries[Index + 1];
+    case djTYPE_F64: {
+      // Floats outside of the range, including integers that didn't fit in 64 bits, are 0
+      dj_f64 Value = djTapeF64(Tape, Index);
+      return Value >= -9223372036854775808.0 && Value < 9223372036854775808.0 ? (dj_s64)Value : 0;
+    }
+  }
+  return 0;
+}
+
+dj_f64 djTapeF64(dj_tape* Tape, size_t Index) {
+  switch (djTapeType(Tape, Index)) {
+    case djTYPE_S64: return (dj_f64)(dj_s64)Tape->Entries[Index + 1];
+    case djTYPE_F64: return _djBitsToF64(Tape->Entries[Index + 1]);
+  }
+  return 0;
+}
+
+dj_string djTapeString(dj_tape* Tape, size_t Index) {
+  dj_string Result = { 0, "" };
+  if (djTapeType(Tape, Index) != djTYPE_STRING)
+    return Result;
+  
+  uint64_t Payload = Tape->Entries[Index] & _DJ_TAPE_PAYLOAD_MASK;
+  if (Payload & _DJ_TAPE_STRING_IN_BUFFER) {
+    Result.Data = Tape->Strings + (Payload & ~_DJ_TAPE_STRING_IN_BUFFER);
+  } else {
+    Result.Data = Tape->Source + Payload;
+  }
+  Result.Length = (size_t)Tape->Entries[Index + 1];
+  return Result;
+}
+
+// Returns the text of a number read from json, the length is 0 if the tape was read from a binary format.
+static dj_string _djTapeNumberText(dj_tape* Tape, size_t Index) {
+  dj_string Result = { 0, "" };
+  uint64_t Payload = Tape->Entries[Index] & _DJ_TAPE_PAYLOAD_MASK;
+  if (!Payload)
+    return Result;
+  
+  // The number has already been read, so it ends at the first char that can't be part of a number
+  Result.Data = Tape->Source + (Payload - 1);
+  const char* End = Result.Data;
+  while (End < Tape->SourceEnd && ((*End >= '0' && *End <= '9') || *End == '-' || *End == '+' || *End == '.' || 
+                                   (*End | 0x20) == 'e'))
+    End += 1;
+  Result.Length = End - Result.Data;
+  return Result;
+}
+
+// ===============================================================================
+// Validation Implementation
+// ===============================================================================
+
+enum {
+  _dj_Validate_Value,
+  _dj_Validate_Key,
+  _dj_Validate_After_Value
+};
+
+static const unsigned char* _djValidateSkipWhiteSpaces(const unsigned char* Char, const unsigned char* End) {
+  if (Char == End || (*Char != ' ' && *Char != '\n' && *Char != '\r' && *Char != '\t'))
+    return Char;
+  
+#ifdef _DJ_SSE2
+  // Indention in pretty printed json is skipped 16 bytes at a time
+  while (End - Char >= 16) {
+    __m128i Bytes = _mm_loadu_si128((const __m128i*)Char);
+    __m128i Spaces = _mm_or_si128(_mm_cmpeq_epi8(Bytes, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(Bytes, _mm_set1_epi8('\n')));
+    Spaces = _mm_or_si128(Spaces, _mm_cmpeq_epi8(Bytes, _mm_set1_epi8('\r')));
+    Spaces = _mm_or_si128(Spaces, _mm_cmpeq_epi8(Bytes, _mm_set1_epi8('\t')));
+    unsigned int Mask = ~(unsigned int)_mm_movemask_epi8(Spaces) & 0xFFFF;
+    if (Mask)
+      return Char + _djCountTrailingZeros(Mask);
+    Char += 16;
+  }
+#endif
+  
+  while (Char < End && (*Char == ' ' || *Char == '\n' || *Char == '\r' || *Char == '\t'))
+    Char += 1;
+  return Char;
+}
+
+// Validates the string starting after the opening quote, returns a pointer after the closing quote or 0 if invalid
+// and then ErrorOut is set to the invalid byte.
+static const unsigned char* _djValidateString(const unsigned char* Char, const unsigned char* End, 
+                                              const unsigned char** ErrorOut) {
+  while (1) {
+#ifdef _DJ_SSE2
+    // Skips 16 bytes at a time until a quote, backslash, control character or non ascii byte is found
+    const __m128i Quote     = _mm_set1_epi8('"');
+    const __m128i Backslash = _mm_set1_epi8('\\');
+    const __m128i Control   = _mm_set1_epi8(0x1F);
+    while (End - Char >= 16) {
+      __m128i Bytes = _mm_loadu_si128((const __m128i*)Char);
+      __m128i Special = _mm_or_si128(_mm_cmpeq_epi8(Bytes, Quote), _mm_cmpeq_epi8(Bytes, Backslash));
+      Special = _mm_or_si128(Special, _mm_cmpeq_epi8(_mm_max_epu8(Bytes, Control), Control));
+      unsigned int Mask = (unsigned int)(_mm_movemask_epi8(Special) | _mm_movemask_epi8(Bytes));
+      if (Mask) {
+        Char += _djCountTrailingZeros(Mask);
+        break;
+      }
+      Char += 16;
+    }
+#endif
+    
+    if (Char == End) {
+      *ErrorOut = Char;
+      return 0;
+    }
+    
+    unsigned char Byte = *Char;
+    if (Byte == '"') {
+      return Char + 1;
+    } else if (Byte == '\\') {
+      if (End - Char < 2) {
+        *ErrorOut = End;
+        return 0;
+      }
+      Byte = Char[1];
+      if (Byte == 'u') {
+        for (int Digit = 2; Digit < 6; Digit++) {
+          if (Char + Digit == End || !Char[Digit] || !strchr("0123456789abcdefABCDEF", Char[Digit])) {
+            *ErrorOut = Char + Digit;
+            return 0;
+          }
+        }
+        Char += 6;
+      } else if (Byte == '"' || Byte == '\\' || Byte == '/' || Byte == 'b' || Byte == 'f' || Byte == 'n' || 
+                 Byte == 'r' || Byte == 't') {
+        Char += 2;
+      } else {
+        *ErrorOut = Char + 1;
+        return 0;
+      }
+    } else if (Byte < 0x20) {
+      *ErrorOut = Char;
+      return 0;
+    } else if (Byte >= 0x80) {
+      int Length = _djValidateUtf8(Char, End);
+      if (!Length) {
+        *ErrorOut = Char;
+        return 0;
+      }
+      Char += Length;
+    } else {
+      Char += 1;
+    }
+  }
+}
+
+// Validates a number, returns a pointer after it or 0 if invalid and then ErrorOut is set to the invalid byte.
+static const unsigned char* _djValidateNumber(const unsigned char* Char, const unsigned char* End, 
+                                              const unsigned char** ErrorOut) {
+  if (Char < End && *Char == '-')
+    Char += 1;
+  
+  if (Char < End && *Char == '0') {
+    Char += 1;
+  } else if (Char < End && *Char >= '1' && *Char <= '9') {
+    while (Char < End && *Char >= '0' && *Char <= '9')
+      Char += 1;
+  } else {
+    *ErrorOut = Char;
+    return 0;
+  }
+  
+  if (Char < End && *Char == '.') {
+    Char += 1;
+    if (Char == End || *Char < '0' || *Char > '9') {
+      *ErrorOut = Char;
+      return 0;
+    }
+    while (Char < End && *Char >= '0' && *Char <= '9')
+      Char += 1;
+  }
+  
+  if (Char < End && (*Char == 'e' || *Char == 'E')) {
+    Char += 1;
+    if (Char < End && (*Char == '+' || *Char == '-'))
+      Char += 1;
+    if (Char == End || *Char < '0' || *Char > '9') {
+      *ErrorOut = Char;
+      return 0;
+    }
+    while (Char < End && *Char >= '0' && *Char <= '9')
+      Char += 1;
+  }
+  return Char;
+}
+
+int djValidate(const char* Data, size_t Length, size_t* ErrorOffset) {
+  const unsigned char* Char = (const unsigned char*)Data;
+  const unsigned char* End  = Char + Length;
+  const unsigned char* Error = 0;
+  
+  // One bit per level, set for objects
+  uint64_t IsObject[(DIR_JSON_VALIDATE_MAX_DEPTH + 63) / 64];
+  int Depth = 0;
+  int State = _dj_Validate_Value;
+  
+  while (!Error) {
+    Char = _djValidateSkipWhiteSpaces(Char, End);
+    
+    if (State == _dj_Validate_After_Value) {
+      if (Depth == 0) {
+        if (Char != End)
+          Error = Char;
+        break;
+      }
+      
+      int InObject = (IsObject[(Depth - 1) / 64] >> ((Depth - 1) % 64)) & 1;
+      if (Char == End) {
+        Error = Char;
+      } else if (*Char == ',') {
+        Char += 1;
+        State = InObject ? _dj_Validate_Key : _dj_Validate_Value;
+      } else if (*Char == (InObject ? '}' : ']')) {
+        Char += 1;
+        Depth -= 1;
+      } else {
+        Error = Char;
+      }
+    } else if (State == _dj_Validate_Key) {
+      if (Char == End || *Char != '"') {
+        Error = Char;
+        break;
+      }
+      Char = _djValidateString(Char + 1, End, &Error);
+      if (!Char)
+        break;
+      Char = _djValidateSkipWhiteSpaces(Char, End);
+      if (Char == End || *Char != ':') {
+        Error = Char;
+        break;
+      }
+      Char += 1;
+      State = _dj_Validate_Value;
+    } else if (Char == End) {
+      Error = Char;
+    } else if (*Char == '{' || *Char == '[') {
+      if (Depth == DIR_JSON_VALIDATE_MAX_DEPTH) {
+        Error = Char;
+        break;
+      }
+      int Object = *Char == '{';
+      uint64_t Bit = 1ull << (Depth % 64);
+      IsObject[Depth / 64] = Object ? (IsObject[Depth / 64] | Bit) : (IsObject[Depth / 64] & ~Bit);
+      Depth += 1;
+      Char += 1;
+      
+      Char = _djValidateSkipWhiteSpaces(Char, End);
+      if (Char < End && *Char == (Object ? '}' : ']')) {
+        Char += 1;
+        Depth -= 1;
+        State = _dj_Validate_After_Value;
+      } else {
+        State = Object ? _dj_Validate_Key : _dj_Validate_Value;
+      }
+    } else if (*Char == '"') {
+      Char = _djValidateString(Char + 1, End, &Error);
+      State = _dj_Validate_After_Value;
+    } else if (*Char == 't' || *Char == 'f' || *Char == 'n') {
+      const char* Literal = *Char == 't' ? "true" : *Char == 'f' ? "false" : "null";
+      size_t LiteralLength = *Char == 'f' ? 5 : 4;
+      for (size_t Index = 0; Index < LiteralLength && !Error; Index++) {
+        if (Char + Index == End || Char[Index] != (unsigned char)Literal[Index])
+          Error = Char + Index;
+      }
+      Char += LiteralLength;
+      State = _dj_Validate_After_Value;
+    } else {
+      Char = _djValidateNumber(Char, End, &Error);
+      State = _dj_Validate_After_Value;
+    }
+  }
+  
+  if (Error && ErrorOffset)
+    *ErrorOffset = (size_t)(Error - (const unsigned char*)Data);
+  return !Error;
+}
+
+// ===============================================================================
+// Projection Implementation
+// ===============================================================================
+
+typedef struct {
+  dj_string Token; // Unescaped
+  dj_s64 Index;    // The token as an array index, -1 if it isn't a valid index
+  dj_s64 MaxIndex; // The largest index of the children
+  int FirstChild;
+  int NextSibling;
+  int Slot;        // The path that ends at this node, -1 if none does
+} _dj_projection_node;
+
+// The paths are stored as a trie where node 0 is the root value.
+struct dj_projection {
+  int PathCount;
+  int NodeCount;
+  _dj_projection_node* Nodes;
+  char* Tokens;
+  
+  int Remaining; // The number of paths not yet found in the current document
+  size_t* StringOffsets;
+  char* Strings;
+  size_t StringsUsed, StringsSize;
+};
+
+static int _djProjectionFindChild(dj_projection* Projection, int NodeIndex, dj_string Key) {
+  int Child = Projection->Nodes[NodeIndex].FirstChild;
+  while (Child >= 0) {
+    dj_string Token = Projection->Nodes[Child].Token;
+    if (Token.Length == Key.Length && memcmp(Token.Data, Key.Data, Key.Length) == 0)
+      break;
+    Child = Projection->Nodes[Child].NextSibling;
+  }
+  return Child;
+}
+
+dj_projection* djInitializeProjection(const char** Paths, int PathCount) {
+  size_t TokensSize = 1;
+  int MaxNodeCount = 1;
+  for (int PathIndex = 0; PathIndex < PathCount; PathIndex++) {
+    const char* Path = Paths[PathIndex];
+    assert((*Path == '\0' || *Path == '/') && "A JSON Pointer needs to be empty or start with '/'. ");
+    for (; *Path; Path++) {
+      MaxNodeCount += *Path == '/';
+      TokensSize += 1;
+    }
+  }
+  
+  dj_projection* Projection = calloc(1, sizeof(dj_projection));
+  assert(Projection && "JSON: Out of memory. ");
+  Projection->PathCount = PathCount;
+  Projection->Nodes = malloc(MaxNodeCount * sizeof(_dj_projection_node));
+  Projection->Tokens = malloc(TokensSize);
+  Projection->StringOffsets = calloc(PathCount + 1, sizeof(size_t));
+  assert(Projection->Nodes && Projection->Tokens && Projection->StringOffsets && "JSON: Out of memory. ");
+  
+  _dj_projection_node Root = { { 0, "" }, -1, -1, -1, -1, -1 };
+  Projection->Nodes[0] = Root;
+  Projection->NodeCount = 1;
+  
+  size_t TokensUsed = 0;
+  for (int PathIndex = 0; PathIndex < PathCount; PathIndex++) {
+    const char* Path = Paths[PathIndex];
+    int NodeIndex = 0;
+    while (*Path == '/') {
+      Path += 1;
+      
+      dj_string Token;
+      Token.Data = Projection->Tokens + TokensUsed;
+      Token.Length = 0;
+      while (*Path && *Path != '/') {
+        char Char = *Path++;
+        if (Char == '~' && (*Path == '0' || *Path == '1'))
+          Char = *Path++ == '0' ? '~' : '/';
+        Projection->Tokens[TokensUsed + Token.Length++] = Char;
+      }
+      
+      int Child = _djProjectionFindChild(Projection, NodeIndex, Token);
+      if (Child < 0) {
+        Child = Projection->NodeCount++;
+        TokensUsed += Token.Length;
+        
+        _dj_projection_node* Parent = &Projection->Nodes[NodeIndex];
+        _dj_projection_node* Node = &Projection->Nodes[Child];
+        *Node = Root;
+        Node->Token = Token;
+        Node->Index = _djPointerTokenIndex(Token);
+        Node->NextSibling = Parent->FirstChild;
+        Parent->FirstChild = Child;
+        if (Node->Index > Parent->MaxIndex)
+          Parent->MaxIndex = Node->Index;
+      }
+      NodeIndex = Child;
+    }
+    
+    assert(Projection->Nodes[NodeIndex].Slot < 0 && "Each path can only be in a projection once. ");
+    Projection->Nodes[NodeIndex].Slot = PathIndex;
+  }
+  
+  return Projection;
+}
+
+void djDestroyProjection(dj_projection* Projection) {
+  free(Projection->Nodes);
+  free(Projection->Tokens);
+  free(Projection->StringOffsets);
+  free(Projection->Strings);
+  free(Projection);
+}
+
+static void _djProjectionReadSlot(dj_read_context* Context, dj_projection* Projection, dj_projection_slot* Slots,
+                                  int SlotIndex) {
+  dj_projection_slot* Slot = &Slots[SlotIndex];
+  if (djReadNextIsObject(Context) || djReadNextIsArray(Context)) {
+    Slot->Type = djReadNextIsObject(Context) ? djTYPE_OBJECT : djTYPE_ARRAY;
+    djReadSkipValue(Context);
+  } else if (djReadNextIsString(Context)) {
+    dj_string String = djReadString(Context);
+    if (Context->Error)
+      return;
+    
+    if (Projection->StringsUsed + String.Length + 1 > Projection->StringsSize) {
+      while (Projection->StringsUsed + String.Length + 1 > Projection->StringsSize)
+        Projection->StringsSize = Projection->StringsSize ? Projection->StringsSize * 2 : 256;
+      Projection->Strings = realloc(Projection->Strings, Projection->StringsSize);
+      assert(Projection->Strings && "JSON: Out of memory. ");
+    }
+    memcpy(Projection->Strings + Projection->StringsUsed, String.Data, String.Length);
+    Projection->Strings[Projection->StringsUsed + String.Length] = '\0';
+    
+    // The buffer can move while the document is read, the pointer is set once it's done
+    Slot->Type = djTYPE_STRING;
+    Slot->String.Length = String.Length;
+    Projection->StringOffsets[SlotIndex] = Projection->StringsUsed;
+    Projection->StringsUsed += String.Length + 1;
+  } else if (djReadNextIsNumber(Context)) {
+    if (_djReadNextIsFloat(Context)) {
+      // Integers that don't fit in 64 bits are floats too, S64 is 0 for values outside of its range
+      Slot->Type = djTYPE_F64;
+      Slot->F64 = djReadF64(Context);
+      Slot->S64 = Slot->F64 >= -9223372036854775808.0 && Slot->F64 < 9223372036854775808.0 ? (dj_s64)Slot->F64 : 0;
+    } else {
+      Slot->Type = djTYPE_S64;
+      Slot->S64 = djReadS64(Context);
+      Slot->F64 = (dj_f64)Slot->S64;
+    }
+  } else if (djReadNextIsBool(Context)) {
+    Slot->Type = djTYPE_BOOL;
+    Slot->Bool = djReadBool(Context);
+  } else if (djReadNextIsNull(Context)) {
+    Slot->Type = djTYPE_NULL;
+    djReadNull(Context);
+  } else {
+    djReadSkipValue(Context); // Reports the error
+    return;
+  }
+  
+  Projection->Remaining -= 1;
+}
+
+static void _djProjectionReadValue(dj_read_context* Context, dj_projection* Projection, dj_projection_slot* Slots,
+                                   int NodeIndex, int Depth) {
+  if (Depth == DIR_JSON_READ_MAX_DEPTH) {
+    djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar, Context->CurrentChar + 1,
+                                     "Containers are nested too deeply. ");
+    return;
+  }
+  
+  _dj_projection_node* Node = &Projection->Nodes[NodeIndex];
+  int HasSlot = Node->Slot >= 0 && Slots[Node->Slot].Type == djTYPE_NONE; // A duplicated key is only read once
+  int IsObject = djReadNextIsObject(Context);
+  int IsArray = !IsObject && djReadNextIsArray(Context);
+  
+  if (Projection->Remaining == 0 || Node->FirstChild < 0 || !(IsObject || IsArray)) {
+    if (HasSlot) {
+      _djProjectionReadSlot(Context, Projection, Slots, Node->Slot);
+    } else {
+      djReadSkipValue(Context);
+    }
+    return;
+  }
+  
+  if (HasSlot) {
+    Slots[Node->Slot].Type = IsObject ? djTYPE_OBJECT : djTYPE_ARRAY;
+    Projection->Remaining -= 1;
+  }
+  
+  if (IsObject) {
+    dj_string Key;
+    int HasEscapes;
+    while (_djReadRawKey(Context, &Key, &HasEscapes)) {
+      if (HasEscapes)
+        Key = _djUnescapeRawString(Context, Key);
+      
+      int Child = _djProjectionFindChild(Projection, NodeIndex, Key);
+      if (Child >= 0) {
+        _djProjectionReadValue(Context, Projection, Slots, Child, Depth + 1);
+      } else {
+        djReadSkipValue(Context);
+      }
+      
+      if (Projection->Remaining == 0) {
+        _djReadSkipRest(Context, 1);
+        break;
+      }
+    }
+  } else {
+    dj_s64 Index = 0;
+    while (djReadArray(Context)) {
+      int Child = Node->FirstChild;
+      while (Child >= 0 && Projection->Nodes[Child].Index != Index)
+        Child = Projection->Nodes[Child].NextSibling;
+      
+      if (Child >= 0) {
+        _djProjectionReadValue(Context, Projection, Slots, Child, Depth + 1);
+      } else {
+        djReadSkipValue(Context);
+      }
+      
+      Index += 1;
+      if (Projection->Remaining == 0 || Index > Node->MaxIndex) {
+        _djReadSkipRest(Context, 0);
+        break;
+      }
+    }
+  }
+}
+
+int djReadProjection(dj_read_context* Context, dj_projection* Projection, dj_projection_slot* Slots) {
+  assert(Context->ShouldReadValueNext);
+  
+  memset(Slots, 0, Projection->PathCount * sizeof(dj_projection_slot));
+  Projection->Remaining = Projection->PathCount;
+  Projection->StringsUsed = 0;
+  
+  _djProjectionReadValue(Context, Projection, Slots, 0, 0);
+  
+  for (int SlotIndex = 0; SlotIndex < Projection->PathCount; SlotIndex++) {
+    if (Slots[SlotIndex].Type == djTYPE_STRING)
+      Slots[SlotIndex].String.Data = Projection->Strings + Projection->StringOffsets[SlotIndex];
+  }
+  
+  return Projection->PathCount - Projection->Remaining;
+}
+
+int djReadNextDocument(dj_read_context* Context) {
+  if (Context->Error || Context->CurrentChar >= Context->EndOfData)
+    return 0;
+  
+  Context->ShouldReadValueNext = 1;
+  return 1;
+}
+
+// ===============================================================================
+// Array Index Implementation
+// ===============================================================================
+
+static const char _dj_Array_Index_Magic[8] = { 'd', 'j', 'i', 'n', 'd', 'e', 'x', '1' };
+
+struct dj_array_index {
+  dj_s64 ElementCount;
+  dj_s64 Stride;
+  dj_s64 OffsetCount; // The last offset is the end of the array
+  dj_s64 OffsetCapacity;
+  dj_s64* Offsets;
+};
+
+static void _djArrayIndexPush(dj_array_index* Index, dj_s64 Offset) {
+  if (Index->OffsetCount == Index->OffsetCapacity) {
+    Index->OffsetCapacity = Index->OffsetCapacity ? Index->OffsetCapacity * 2 : 256;
+    Index->Offsets = realloc(Index->Offsets, Index->OffsetCapacity * sizeof(dj_s64));
+    assert(Index->Offsets && "JSON: Out of memory. ");
+  }
+  Index->Offsets[Index->OffsetCount++] = Offset;
+}
+
+dj_array_index* djBuildArrayIndex(dj_read_context* Context, int Stride) {
+  assert(Context->Format == djFORMAT_JSON && "Only json files can be indexed. ");
+  assert(Stride > 0);
+  
+  dj_array_index* Index = calloc(1, sizeof(dj_array_index));
+  assert(Index && "JSON: Out of memory. ");
+  Index->Stride = Stride;
+  
+  while (djReadArray(Context)) {
+    if (Index->ElementCount % Stride == 0)
+      _djArrayIndexPush(Index, Context->CurrentChar - Context->JsonData);
+    djReadSkipValue(Context);
+    Index->ElementCount += 1;
+  }
+  _djArrayIndexPush(Index, Context->CurrentChar - Context->JsonData);
+  
+  if (Context->Error) {
+    djDestroyArrayIndex(Index);
+    return 0;
+  }
+  return Index;
+}
+
+int djSaveArrayIndex(dj_array_index* Index, const char* FilePath) {
+  FILE* File = fopen(FilePath, "wb");
+  if (!File)
+    return 0;
+  
+  // The offsets are stored in the byte order of the machine, the index is only meant to be used where it's built
+  int Success = fwrite(_dj_Array_Index_Magic, sizeof(_dj_Array_Index_Magic), 1, File) == 1 &&
+                fwrite(&Index->ElementCount, sizeof(dj_s64), 1, File) == 1 &&
+                fwrite(&Index->Stride,       sizeof(dj_s64), 1, File) == 1 &&
+                fwrite(&Index->OffsetCount,  sizeof(dj_s64), 1, File) == 1 &&
+                fwrite(Index->Offsets, sizeof(dj_s64), (size_t)Index->OffsetCount, File) == (size_t)Index->OffsetCount;
+  
+  if (fclose(File))
+    Success = 0;
+  return Success;
+}
+
+dj_array_index* djLoadArrayIndex(const char* FilePath) {
+  FILE* File = fopen(FilePath, "rb");
+  if (!File)
+    return 0;
+  
+  char Magic[sizeof(_dj_Array_Index_Magic)];
+  dj_array_index* Index = calloc(1, sizeof(dj_array_index));
+  assert(Index && "JSON: Out of memory. ");
+  
+  int Success = fread(Magic, sizeof(Magic), 1, File) == 1 && 
+                memcmp(Magic, _dj_Array_Index_Magic, sizeof(Magic)) == 0 &&
+                fread(&Index->ElementCount, sizeof(dj_s64), 1, File) == 1 &&
+                fread(&Index->Stride,       sizeof(dj_s64), 1, File) == 1 &&
+                fread(&Index->OffsetCount,  sizeof(dj_s64), 1, File) == 1 &&
+                Index->Stride > 0 && Index->ElementCount >= 0 &&
+                Index->OffsetCount == (Index->ElementCount + Index->Stride - 1) / Index->Stride + 1;
+  if (Success) {
+    Index->OffsetCapacity = Index->OffsetCount;
+    Index->Offsets = malloc(Index->OffsetCount * sizeof(dj_s64));
+    assert(Index->Offsets && "JSON: Out of memory. ");
+    Success = fread(Index->Offsets, sizeof(dj_s64), (size_t)Index->OffsetCount, File) == (size_t)Index->OffsetCount;
+  }
+  fclose(File);
+  
+  if (!Success) {
+    djDestroyArrayIndex(Index);
+    return 0;
+  }
+  return Index;
+}
+
+void djDestroyArrayIndex(dj_array_index* Index) {
+  free(Index->Offsets);
+  free(Index);
+}
+
+dj_s64 djArrayIndexCount(dj_array_index* Index) {
+  return Index->ElementCount;
+}
+
+// Seeks with 64 bit offsets, fseek only takes a long which is 32 bits on Windows and 32 bit platforms.
+static int _djSeekFile(FILE* File, dj_s64 Offset) {
+#if defined(_WIN32)
+  return _fseeki64(File, Offset, SEEK_SET);
+#elif defined(__STRICT_ANSI__) && !defined(_POSIX_C_SOURCE) && !defined(_XOPEN_SOURCE)
+  if ((dj_s64)(long)Offset != Offset)
+    return -1; // fseeko isn't declared when compiling as strict ISO C
+  return fseek(File, (long)Offset, SEEK_SET);
+#else
+  if ((dj_s64)(off_t)Offset != Offset)
+    return -1; // off_t is 32 bits unless _FILE_OFFSET_BITS is 64
+  return fseeko(File, (off_t)Offset, SEEK_SET);
+#endif
+}
+
+dj_read_context* djReadFromArrayIndex(const char* FilePath, dj_array_index* Index, dj_s64 Element) {
+  assert(Element >= 0 && Element < Index->ElementCount);
+  dj_read_context* Context = _djCreateReadContext();
+  
+  if (djReadError(Context))
+    return Context;
+  
+  FILE* File = fopen(FilePath, "rb");
+  if (!File) {
+    _djInitializationOutOfMemoryError(Context, "Failed to open file. ");
+    return Context;
+  }
+  
+  // The elements of the stride are read into an array of their own by putting a '[' in front and replacing the ',' 
+  // in front of the next indexed element with a ']', the last stride already ends with the ']' of the array.
+  dj_s64 Block = Element / Index->Stride;
+  dj_s64 Start = Index->Offsets[Block];
+  size_t Size  = (size_t)(Index->Offsets[Block + 1] - Start);
+  
+  char* Data = malloc(Size + 2);
+  if (!Data) {
+    _djInitializationOutOfMemoryError(Context, "Couldn't allocate data for the file content. ");
+    fclose(File);
+    return Context;
+  }
+  
+  if (_djSeekFile(File, Start) || fread(Data + 1, 1, Size, File) != Size) {
+    _djInitializationOutOfMemoryError(Context, "Couldn't read file. ");
+    free(Data);
+    fclose(File);
+    return Context;
+  }
+  fclose(File);
+  
+  Data[0] = '[';
+  Data[Size + 1] = '\0';
+  if (Block + 2 < Index->OffsetCount) {
+    char* Separator = Data + Size;
+    while (Separator > Data && *Separator != ',')
+      --Separator;
+    *Separator = ']';
+  }
+  
+  Context->JsonDataOwnagePtr  = Data;
+  Context->JsonData           = Data;
+  Context->CurrentChar        = Data;
+  Context->EndOfData          = Data + Size + 1;
+  
+  for (dj_s64 Skipped = Block * Index->Stride; Skipped < Element && djReadArray(Context); Skipped++) {
+    djReadSkipValue(Context);
+  }
+  return Context;
+}
+
+// ===============================================================================
+// Push Implementation
+// ===============================================================================
+
+enum {
+  _dj_Push_Value,        // A value, at the top level this is the start of the next document
+  _dj_Push_Value_Or_End, // After '['
+  _dj_Push_Key_Or_End,   // After '{'
+  _dj_Push_Key,          // After ',' in an object
+  _dj_Push_Colon,
+  _dj_Push_Comma_Or_End
+};
+
+enum {
+  _dj_Push_Token_None,
+  _dj_Push_Token_String,
+  _dj_Push_Token_Number,
+  _dj_Push_Token_Literal // true, false or null
+};
+
+dj_read_context* djReadPush(const dj_push_callbacks* Callbacks, void* Ptr) {
+  dj_read_context* Context = _djCreateReadContext();
+  
+  if (djReadError(Context))
+    return Context;
+  
+  Context->Push.Callbacks = *Callbacks;
+  Context->Push.Ptr       = Ptr;
+  return Context;
+}
+
+static void _djPushAppendToken(dj_read_context* Context, const char* Data, const char* End) {
+  _dj_push* Push = &Context->Push;
+  size_t Length = End - Data;
+  if (Push->TokenLength + Length > Push->TokenSize) {
+    Push->TokenSize = Push->TokenSize ? Push->TokenSize * 2 : 64;
+    if (Push->TokenSize < Push->TokenLength + Length)
+      Push->TokenSize = Push->TokenLength + Length;
+    Push->TokenData = realloc(Push->TokenData, Push->TokenSize);
+    assert(Push->TokenData && "JSON: Out of memory. ");
+  }
+  memcpy(Push->TokenData + Push->TokenLength, Data, Length);
+  Push->TokenLength += Length;
+}
+
+// Scans for the end of the token in progress, returns 0 if the data ends before the token does.
+static const char* _djPushScanToken(dj_read_context* Context, const char* Char, const char* End) {
+  _dj_push* Push = &Context->Push;
+  if (Push->Token == _dj_Push_Token_String) {
+    while (Char < End) {
+      if (Push->InEscape) {
+        Push->InEscape = 0;
+        Char += 1;
+        continue;
+      }
+      Char = _djFindQuoteOrBackslash(Char, End);
+      if (Char == End)
+        break;
+      if (*Char == '"')
+        return Char + 1;
+      Push->InEscape = 1;
+      Char += 1;
+    }
+    return 0;
+  }
+  
+  // Numbers and literals ends at the first character that can't be a part of them, the read functions checks them
+  if (Push->Token == _dj_Push_Token_Number) {
+    while (Char < End && ((*Char >= '0' && *Char <= '9') || *Char == '-' || *Char == '+' || *Char == '.' || 
+                          *Char == 'e' || *Char == 'E'))
+      Char += 1;
+  } else {
+    while (Char < End && *Char >= 'a' && *Char <= 'z')
+      Char += 1;
+  }
+  return Char < End ? Char : 0;
+}
+
+// Called after a value is complete, either in the data or as a part of a container.
+static void _djPushEndValue(dj_read_context* Context) {
+  _dj_push* Push = &Context->Push;
+  if (Context->ContainerDepth) {
+    Push->State = _dj_Push_Comma_Or_End;
+  } else {
+    Push->State = _dj_Push_Value;
+    if (Push->Callbacks.EndDocument)
+      Push->Callbacks.EndDocument(Context, Push->Ptr);
+  }
+}
+
+// Reads the token between Start and End with the normal read functions and calls the callback for it.
+static void _djPushEmitToken(dj_read_context* Context, const char* Data, const char* Start, const char* End) {
+  _dj_push* Push = &Context->Push;
+  int Token = Push->Token;
+  Push->Token       = _dj_Push_Token_None;
+  Push->TokenLength = 0;
+  
+  Context->JsonData    = Data;
+  Context->CurrentChar = Start;
+  Context->EndOfData   = End;
+  Context->ShouldReadValueNext = 1;
+  
+  dj_string String;
+  dj_s64 S64 = 0;
+  dj_f64 F64 = 0;
+  int IsFloat = 0;
+  int Bool = 0;
+  if (Token == _dj_Push_Token_String) {
+    String = djReadString(Context);
+  } else if (Token == _dj_Push_Token_Number) {
+    IsFloat = _djReadNextIsFloat(Context);
+    if (IsFloat)
+      F64 = djReadF64(Context);
+    else
+      S64 = djReadS64(Context);
+  } else if (*Start == 'n') {
+    djReadNull(Context);
+  } else {
+    Bool = djReadBool(Context);
+  }
+  
+  if (!Context->Error && Context->CurrentChar != End) {
+    djReadReportErrorIfNoErrorExists(Context, Context->CurrentChar, Context->CurrentChar + 1,
+                                     "Unexpected character after the value. ");
+  }
+  if (Context->Error)
+    return;
+  
+  const dj_push_callbacks* Callbacks = &Push->Callbacks;
+  if (Token == _dj_Push_Token_String && Push->TokenIsKey) {
+    if (Callbacks->Key)
+      Callbacks->Key(Context, Push->Ptr, String);
+    Push->State = _dj_Push_Colon;
+    return;
+  }
+  
+  if (Token == _dj_Push_Token_String) {
+    if (Callbacks->String) Callbacks->String(Context, Push->Ptr, String);
+  } else if (Token == _dj_Push_Token_Number && IsFloat) {
+    if (Callbacks->F64) Callbacks->F64(Context, Push->Ptr, F64);
+  } else if (Token == _dj_Push_Token_Number) {
+    if (Callbacks->S64) Callbacks->S64(Context, Push->Ptr, S64);
+  } else if (*Start == 'n') {
+    if (Callbacks->Null) Callbacks->Null(Context, Push->Ptr);
+  } else {
+    if (Callbacks->Bool) Callbacks->Bool(Context, Push->Ptr, Bool);
+  }
+  _djPushEndValue(Context);
+}
+
+static void _djPushStartContainer(dj_read_context* Context, const char* Char, int IsObject) {
+  _dj_push* Push = &Context->Push;
+  if (Context->ContainerDepth == DIR_JSON_READ_MAX_DEPTH) {
+    djReadReportErrorIfNoErrorExists(Context, Char, Char + 1, "Containers are nested too deeply. ");
+    return;
+  }
+  
+  _dj_read_container* Container = &Context->Containers[Context->ContainerDepth++];
+  Container->Remaining = 0;
+  Container->IsObject  = IsObject;
+  
+  if (IsObject) {
+    Push->State = _dj_Push_Key_Or_End;
+    if (Push->Callbacks.StartObject)
+      Push->Callbacks.StartObject(Context, Push->Ptr);
+  } else {
+    Push->State = _dj_Push_Value_Or_End;
+    if (Push->Callbacks.StartArray)
+      Push->Callbacks.StartArray(Context, Push->Ptr);
+  }
+}
+
+static void _djPushEndContainer(dj_read_context* Context) {
+  _dj_push* Push = &Context->Push;
+  int IsObject = Context->Containers[--Context->ContainerDepth].IsObject;
+  if (IsObject && Push->Callbacks.EndObject)
+    Push->Callbacks.EndObject(Context, Push->Ptr);
+  else if (!IsObject && Push->Callbacks.EndArray)
+    Push->Callbacks.EndArray(Context, Push->Ptr);
+  _djPushEndValue(Context);
+}
+
+int djReadFeed(dj_read_context* Context, const char* Data, size_t Length) {
+  _dj_push* Push = &Context->Push;
+  if (Context->Error)
+    return 0;
+  
+  // Errors are reported with an excerpt of this data, so the line and column are relative to it
+  const char* Char = Data;
+  const char* End  = Data + Length;
+  Context->BytesScannedBefore += Context->EndOfData - Context->JsonData; // All of the previous data was consumed
+  Context->JsonData    = Data;
+  Context->CurrentChar = Data;
+  Context->EndOfData   = End;
+  
+  if (Push->Token != _dj_Push_Token_None) {
+    const char* TokenEnd = _djPushScanToken(Context, Char, End);
+    _djPushAppendToken(Context, Char, TokenEnd ? TokenEnd : End);
+    if (!TokenEnd) {
+      Context->CurrentChar = End;
+      return 1;
+    }
+    
+    _djPushEmitToken(Context, Push->TokenData, Push->TokenData, Push->TokenData + Push->TokenLength);
+    if (Context->Error)
+      return 0;
+    Context->JsonData  = Data;
+    Context->EndOfData = End;
+    Char = TokenEnd;
+  }
+  
+  while (Char < End) {
+    char Current = *Char;
+    if (Current == ' ' || Current == '\n' || Current == '\r' || Current == '\t') {
+      Char += 1;
+      continue;
+    }
+    
+    int State = Push->State;
+    int Token = _dj_Push_Token_None;
+    if (State == _dj_Push_Value || State == _dj_Push_Value_Or_End) {
+      if (Current == '{' || Current == '[') {
+        _djPushStartContainer(Context, Char, Current == '{');
+      } else if (Current == ']' && State == _dj_Push_Value_Or_End) {
+        _djPushEndContainer(Context);
+      } else if (Current == '"') {
+        Token = _dj_Push_Token_String;
+      } else if (Current == '-' || (Current >= '0' && Current <= '9')) {
+        Token = _dj_Push_Token_Number;
+      } else if (Current >= 'a' && Current <= 'z') {
+        Token = _dj_Push_Token_Literal;
+      } else {
+        djReadReportErrorIfNoErrorExists(Context, Char, Char + 1, "Expected a value. ");
+      }
+    } else if (State == _dj_Push_Key || State == _dj_Push_Key_Or_End) {
+      if (Current == '"') {
+        Token = _dj_Push_Token_String;
+      } else if (Current == '}' && State == _dj_Push_Key_Or_End) {
+        _djPushEndContainer(Context);
+      } else {
+        djReadReportErrorIfNoErrorExists(Context, Char, Char + 1, "Expected a key. ");
+      }
+    } else if (State == _dj_Push_Colon) {
+      if (Current == ':') {
+        Push->State = _dj_Push_Value;
+      } else {
+        djReadReportErrorIfNoErrorExists(Context, Char, Char + 1, 
+                                         "A colon needs to follow the key for each member.");
+      }
+    } else {
+      int IsObject = Context->Containers[Context->ContainerDepth - 1].IsObject;
+      if (Current == ',') {
+        Push->State = IsObject ? _dj_Push_Key : _dj_Push_Value;
+      } else if (Current == (IsObject ? '}' : ']')) {
+        _djPushEndContainer(Context);
+      } else {
+        djReadReportErrorIfNoErrorExists(Context, Char, Char + 1, 
+                                         IsObject ? "Expected a ',' or '}'. " : "Expected a ',' or ']'. ");
+      }
+    }
+    if (Context->Error)
+      return 0;
+    
+    if (Token == _dj_Push_Token_None) {
+      Char += 1;
+      continue;
+    }
+    
+    // Tokens that are complete in this data are read directly from it, otherwise the start is kept for next feed
+    Push->Token      = Token;
+    Push->TokenIsKey = State == _dj_Push_Key || State == _dj_Push_Key_Or_End;
+    Push->InEscape   = 0;
+    const char* TokenEnd = _djPushScanToken(Context, Token == _dj_Push_Token_String ? Char + 1 : Char, End);
+    if (!TokenEnd) {
+      _djPushAppendToken(Context, Char, End);
+      Context->CurrentChar = End;
+      return 1;
+    }
+    
+    _djPushEmitToken(Context, Data, Char, TokenEnd);
+    if (Context->Error)
+      return 0;
+    Context->JsonData  = Data;
+    Context->EndOfData = End;
+    Char = TokenEnd;
+  }
+  
+  Context->CurrentChar = End;
+  return 1;
+}
+
+int djReadFeedEnd(dj_read_context* Context) {
+  _dj_push* Push = &Context->Push;
+  if (Context->Error)
+    return 0;
+  
+  // Any error is reported with an excerpt of the unfinished token, its bytes are counted again when it's read
+  Context->BytesScannedBefore += (Context->EndOfData - Context->JsonData) - Push->TokenLength;
+  Context->JsonData    = Push->TokenData ? Push->TokenData : "\0";
+  Context->CurrentChar = Context->JsonData;
+  Context->EndOfData   = Context->JsonData + Push->TokenLength;
+  
+  if (Push->Token == _dj_Push_Token_String) {
+    djReadReportErrorIfNoErrorExists(Context, Context->EndOfData, Context->EndOfData + 1,
+                                     "Reached end of the file before closing the string. ");
+  } else if (Push->Token != _dj_Push_Token_None) {
+    _djPushEmitToken(Context, Push->TokenData, Push->TokenData, Push->TokenData + Push->TokenLength);
+  }
+  
+  if (Context->ContainerDepth) {
+    djReadReportErrorIfNoErrorExists(Context, 0, 0, "Reached end of the file before the end of the value. ");
+  }
+  return !Context->Error;
+}
+
+#ifdef DIR_JSON_ZLIB
+int djReadFeedGzipFile(dj_read_context* Context, const char* FilePath) {
+  if (Context->Error)
+    return 0;
+  
+  gzFile File = gzopen(FilePath, "rb");
+  if (!File) {
+    djReadReportErrorIfNoErrorExists(Context, 0, 0, "Failed to open file. ");
+    return 0;
+  }
+  gzbuffer(File, DIR_JSON_GZIP_BLOCK_SIZE);
+  
+  // djReadFeed doesn't keep the data, so the same block is reused for the whole file
+  char* Block = malloc(DIR_JSON_GZIP_BLOCK_SIZE);
+  assert(Block && "JSON: Out of memory. ");
+  int AmountRead;
+  while ((AmountRead = gzread(File, Block, DIR_JSON_GZIP_BLOCK_SIZE)) > 0) {
+    if (!djReadFeed(Context, Block, AmountRead))
+      break;
+  }
+  free(Block);
+  
+  int CloseResult = gzclose(File); // Reports truncated files
+  if (AmountRead < 0 || CloseResult != Z_OK)
+    djReadReportErrorIfNoErrorExists(Context, 0, 0, "Couldn't decompress file. ");
+  return djReadFeedEnd(Context);
+}
+#endif
+
+
+// ===============================================================================
+// Write Implementation
+// ===============================================================================
+
+const char _dj_Spaces_Array[]= "                                                             ";
+enum {
+  _dj_Context_Clue_First_Item,
+  _dj_Context_Clue_Member_Value,
+  _dj_Context_Clue_Write_Comma
+};
+
+// Moves the buffer to the segments, the caller needs to set a new buffer.
+static void _djPushSegment(dj_write_context* Context) {
+  if (Context->SegmentCount == Context->SegmentCapacity) {
+    Context->SegmentCapacity = Context->SegmentCapacity ? Context->SegmentCapacity * 2 : 16;
+    Context->Segments = realloc(Context->Segments, Context->SegmentCapacity * sizeof(dj_segment));
+    assert(Context->Segments && "JSON: Out of memory. ");
+  }
+  dj_segment* Segment = &Context->Segments[Context->SegmentCount++];
+  Segment->Data   = Context->Buffer;
+  Segment->Length = Context->Used;
+  Context->Flushed += Context->Used;
+  Context->Buffer = 0;
+  Context->Used   = 0;
+}
+
+#ifdef DIR_JSON_MMAP
+// Maps the file from Position to End, growing the file first so the whole window is backed by it.
+static void _djMapFileWindow(dj_write_context* Context, dj_s64 Position, dj_s64 End) {
+  if (Context->MapBase)
+    munmap(Context->MapBase, Context->MapSize);
+  Context->MapBase = 0;
+  
+  dj_s64 Offset = Position - Position % Context->PageSize;
+  size_t Length = (size_t)(End - Offset);
+  
+  // The window is the buffer so its size has to fit in an int, and the end has to fit in a file offset
+  int IsRepresentable = End - Position <= INT_MAX && (dj_s64)Length == End - Offset && (dj_s64)(off_t)End == End;
+  void* Base = MAP_FAILED;
+  if (IsRepresentable && ftruncate(Context->MappedFile, (off_t)End) == 0)
+    Base = mmap(0, Length, PROT_READ | PROT_WRITE, MAP_SHARED, Context->MappedFile, (off_t)Offset);
+  
+  if (Base == MAP_FAILED) {
+    // Nothing more can be written, the rest of the output is only counted
+    if (!Context->Error)
+      Context->Error = IsRepresentable ? "Failed to write to file. " : "The mapped window is too large. ";
+    Context->Buffer = Context->Scratch;
+    Context->Size   = sizeof(Context->Scratch);
+  } else {
+    Context->MapBase = Base;
+    Context->MapSize = Length;
+    Context->Buffer  = Context->MapBase + (Position - Offset);
+    Context->Size    = (int)(End - Position);
+  }
+}
+#endif
+
+static void _djFlushBuffer(dj_write_context* Context) {
+  if (Context->FixedBuffer) {
+    if (Context->Buffer == Context->FixedBuffer) {
+      Context->FixedUsed = Context->Used;
+      Context->Buffer    = Context->Scratch;
+      Context->Size      = sizeof(Context->Scratch);
+      if (!Context->Error)
+        Context->Error = "The buffer is too small. ";
+    } else {
+      Context->Overflow += Context->Used;
+    }
+    Context->Used = 0;
+#ifdef DIR_JSON_MMAP
+  } else if (Context->IsMappedFile) {
+    if (Context->Buffer != Context->Scratch && Context->Format == djFORMAT_MSGPACK && Context->ContainerDepth > 0) {
+      // The header of an open container is patched when it's closed so the window grows instead of moving
+      _DJ_STAT_ADD(Context, BufferReallocs, 1);
+      _djMapFileWindow(Context, Context->Flushed, Context->Flushed + 2 * (dj_s64)Context->Size);
+    } else {
+      _DJ_STAT_ADD(Context, Flushes, 1);
+      _DJ_STAT_ADD(Context, BytesWritten, Context->Used);
+      Context->Flushed += Context->Used;
+      Context->Used = 0;
+      if (Context->Buffer != Context->Scratch)
+        _djMapFileWindow(Context, Context->Flushed, Context->Flushed + Context->WindowSize);
+    }
+    if (Context->Buffer == Context->Scratch) {
+      Context->Flushed += Context->Used;
+      Context->Used = 0;
+    }
+#endif
+  } else if (Context->Format == djFORMAT_MSGPACK && Context->ContainerDepth > 0) {
+    // The header of an open container is patched when it's closed so it has to stay in the buffer
+    _DJ_STAT_ADD(Context, BufferReallocs, 1);
+    Context->Size = Context->Size * 2;
+    Context->Buffer = realloc(Context->Buffer, Context->Size);
+    assert(Context->Buffer);
+  } else if (Context->TargetFile) {
+    _DJ_STAT_ADD(Context, Flushes, 1);
+    _DJ_STAT_ADD(Context, BytesWritten, Context->Used);
+    Context->Flushed += Context->Used;
+    size_t AmountWritten = fwrite(Context->Buffer, 1, Context->Used, Context->TargetFile);
+    if (AmountWritten != Context->Used && !Context->Error) {
+      Context->Error = "Failed to write to file. ";
+    }
+    Context->Used = 0;
+#ifdef DIR_JSON_ZLIB
+  } else if (Context->TargetGzipFile) {
+    _DJ_STAT_ADD(Context, Flushes, 1);
+    _DJ_STAT_ADD(Context, BytesWritten, Context->Used);
+    Context->Flushed += Context->Used;
+    if (Context->Used && gzwrite(Context->TargetGzipFile, Context->Buffer, Context->Used) != Context->Used &&
+        !Context->Error) {
+      Context->Error = "Failed to write to gzip file. ";
+    }
+    Context->Used = 0;
+#endif
+  } else if (Context->IsSegmented) {
+    // The full buffer is kept as it is and a new one is started, so nothing written is ever copied
+    _DJ_STAT_ADD(Context, Flushes, 1);
+    _DJ_STAT_ADD(Context, BytesWritten, Context->Used);
+    _djPushSegment(Context);
+    Context->Buffer = malloc(Context->Size);
+    assert(Context->Buffer && "JSON: Out of memory. ");
+  } else if (Context->Callback) {
+    _DJ_STAT_ADD(Context, Flushes, 1);
+    _DJ_STAT_ADD(Context, BytesWritten, Context->Used);
+    Context->Flushed += Context->Used;
+    Context->Callback(Context, Context->Buffer, Context->Used);
+    Context->Used = 0;
+  } else {
+    _DJ_STAT_ADD(Context, BufferReallocs, 1);
+    Context->Size = Context->Size * 2 > 128 ? Context->Size * 2 : 128;
+    Context->Buffer = realloc(Context->Buffer, Context->Size);
+    assert(Context->Buffer);
+  }
+}
+
+static void _djWriteChar(dj_write_context* Context, char Char) {
+  if (Context->Used == Context->Size) {
+    _djFlushBuffer(Context);
+  }
+  Context->Buffer[Context->Used++] = Char;
+}
+
+static void _djWriteN(dj_write_context* Context, const char* Data, int Count) {
+  int AmountWritten = 0;
+  while (1) {
+    int AmountLeft    = Count - AmountWritten;
+    int AmountToWrite = AmountLeft < Context->Size - Context->Used ? AmountLeft : Context->Size - Context->Used;
+    memcpy(Context->Buffer + Context->Used, Data + AmountWritten, AmountToWrite);
+    Context->Used += AmountToWrite;
+    AmountWritten += AmountToWrite;
+    if (AmountWritten == Count) {
+      break;
+    } else {
+      _djFlushBuffer(Context);
+    }
+  }
+}
+
+static void _djWriteNewItem(dj_write_context* Context) {
+  if (Context->PrettyPrint) {
+    if (Context->IsRootValue) {
+      Context->IsRootValue = 0;
+    } else {
+      if (Context->ContextClue != _dj_Context_Clue_Member_Value) {
+        if (Context->ContextClue == _dj_Context_Clue_Write_Comma)
+          _djWriteChar(Context, ',');
+        _djWriteChar(Context, '\n');
+        int SpacesLeftToWrite = Context->Indention;
+        while (SpacesLeftToWrite > 0) {
+          int SpacesWritten = SpacesLeftToWrite < (int)sizeof(_dj_Spaces_Array) - 1 ? SpacesLeftToWrite : 
+                                                                                  (int)sizeof(_dj_Spaces_Array) - 1;
+          _djWriteN(Context, _dj_Spaces_Array, SpacesWritten);
+          SpacesLeftToWrite -= SpacesWritten;
+        }
+      } else {
+        _djWriteChar(Context, ' ');
+      }
+    }
+  } else {
+    switch (Context->ContextClue) {
+      case _dj_Context_Clue_First_Item: {
+      } break;
+      case _dj_Context_Clue_Member_Value: {
+      } break;
+      case _dj_Context_Clue_Write_Comma: {
+        _djWriteChar(Context, ',');
+      } break;
+    }
+  }
+  Context->ContextClue = _dj_Context_Clue_Write_Comma;
+}
+
+static dj_write_context* _djCreateWriteContext(int BufferSize) {
+  dj_write_context* Context = calloc(1, sizeof(dj_write_context));
+  assert(Context && "JSON: Out of memory. ");
+  Context->ContextClue = _dj_Context_Clue_First_Item;
+  Context->IsRootValue = 1;
+  
+  Context->Size   = BufferSize > 0 ? BufferSize : 512;
+  Context->Buffer = malloc(Context->Size);
+  assert(Context->Buffer && "JSON: Out of memory. ");
+  
+  return Context;
+}
+
+dj_write_context* djWriteInitializeContextTargetString(int StartBufferSize) {
+  return _djCreateWriteContext(StartBufferSize);
+}
+
+dj_write_context* djWriteInitializeContextTargetFile(FILE* File, int BufferSize) {
+  dj_write_context* Context = _djCreateWriteContext(BufferSize);
+  
+  Context->TargetFile  = File;
+  
+  return Context;
+}
+
+dj_write_context* djWriteInitializeContextTargetFilePath(const char* FilePath, int BufferSize) {
+  FILE* File = fopen(FilePath, "w");
+  
+  dj_write_context* Context = _djCreateWriteContext(BufferSize);
+  
+  Context->TargetFile      = File;
+  Context->ShouldCloseFile = File != 0;
+  Context->Error           = File != 0 ? 0 : "Could not open file. ";
+  
+  return Context;
+}
+
+dj_write_context* djWriteInitializeContextTargetCustom(dj_write_callback Callback, int BufferSize)  {
+  dj_write_context* Context = _djCreateWriteContext(BufferSize);
+  
+  Context->Callback = Callback;
+  
+  return Context;
+}
+
+dj_write_context* djWriteInitializeContextTargetBuffer(char* Buffer, int Size) {
+  // Only the context is allocated, the output goes straight into the callers buffer
+  dj_write_context* Context = calloc(1, sizeof(dj_write_context));
+  assert(Context && "JSON: Out of memory. ");
+  Context->ContextClue = _dj_Context_Clue_First_Item;
+  Context->IsRootValue = 1;
+  
+  Context->FixedBuffer = Buffer;
+  Context->FixedSize   = Size;
+  Context->Buffer      = Buffer;
+  Context->Size        = Size;
+  
+  return Context;
+}
+
+dj_write_context* djWriteInitializeContextTargetSegments(int SegmentSize) {
+  dj_write_context* Context = _djCreateWriteContext(SegmentSize > 0 ? SegmentSize : 64 * 1024);
+  
+  Context->IsSegmented = 1;
+  
+  return Context;
+}
+
+#ifdef DIR_JSON_ZLIB
+dj_write_context* djWriteInitializeContextTargetGzipFilePath(const char* FilePath, int BufferSize, int Level) {
+  char Mode[4] = { 'w', 'b', '\0', '\0' };
+  if (Level >= 0 && Level <= 9)
+    Mode[2] = (char)('0' + Level);
+  gzFile File = gzopen(FilePath, Mode);
+  
+  dj_write_context* Context = _djCreateWriteContext(BufferSize);
+  
+  Context->TargetGzipFile = File;
+  Context->Error          = File != 0 ? 0 : "Could not open file. ";
+  
+  return Context;
+}
+#endif
+
+#ifdef DIR_JSON_MMAP
+dj_write_context* djWriteInitializeContextTargetMappedFilePath(const char* FilePath, int WindowSize) {
+  int File = open(FilePath, O_RDWR | O_CREAT | O_TRUNC, 0666);
+  if (File < 0) {
+    dj_write_context* Context = _djCreateWriteContext(0);
+    Context->Error = "Could not open file. ";
+    return Context;
+  }
+  
+  // The buffer is the mapping, so only the context is allocated
+  dj_write_context* Context = calloc(1, sizeof(dj_write_context));
+  assert(Context && "JSON: Out of memory. ");
+  Context->ContextClue = _dj_Context_Clue_First_Item;
+  Context->IsRootValue = 1;
+  
+  Context->IsMappedFile = 1;
+  Context->MappedFile   = File;
+  Context->PageSize     = sysconf(_SC_PAGESIZE);
+  WindowSize = WindowSize > 0 ? WindowSize : 64 * 1024 * 1024;
+  dj_s64 RoundedSize = (WindowSize + Context->PageSize - 1) / Context->PageSize * Context->PageSize;
+  Context->WindowSize   = (int)(RoundedSize <= INT_MAX ? RoundedSize : RoundedSize - Context->PageSize);
+  
+  _djMapFileWindow(Context, 0, Context->WindowSize);
+  
+  return Context;
+}
+#endif
+
+void djWriteSetPrettyPrint(dj_write_context* Context, int ShouldPrettyPrint) {
+  Context->PrettyPrint = ShouldPrettyPrint;
+}
+
+void djWriteSetFormat(dj_write_context* Context, int Format) {
+  assert(Context->Used == 0 && Context->IsRootValue && "The format needs to be set before anything is written. ");
+  assert(Format == djFORMAT_JSON || Format == djFORMAT_MSGPACK || Format == djFORMAT_CBOR);
+  Context->Format = Format;
+}
+
+const char* djWriteFinalizeWithLength(dj_write_context* Context, size_t* LengthOut) {
+  const char* Result = 0;
+  int HasTerminator = 0;
+  if (Context->TargetFile) {
+    _djFlushBuffer(Context);
+    if (Context->ShouldCloseFile) {
+      fclose(Context->TargetFile);
+    }
+#ifdef DIR_JSON_ZLIB
+  } else if (Context->TargetGzipFile) {
+    _djFlushBuffer(Context);
+    if (gzclose(Context->TargetGzipFile) != Z_OK && !Context->Error) {
+      Context->Error = "Failed to write to gzip file. ";
+    }
+    Context->TargetGzipFile = 0;
+#endif
+#ifdef DIR_JSON_MMAP
+  } else if (Context->IsMappedFile) {
+    // The file was grown a window at a time, so it's truncated to what was actually written
+    if (Context->MapBase)
+      munmap(Context->MapBase, Context->MapSize);
+    if (ftruncate(Context->MappedFile, (off_t)(Context->Flushed + Context->Used)) != 0 && !Context->Error)
+      Context->Error = "Failed to write to file. ";
+    close(Context->MappedFile);
+    Context->MappedFile = -1;
+    Context->MapBase    = 0;
+    Context->Buffer     = 0;
+#endif
+  } else if (Context->IsSegmented) {
+    if (Context->Used) {
+      _djPushSegment(Context);
+    } else {
+      free(Context->Buffer);
+      Context->Buffer = 0;
+    }
+  } else {
+    HasTerminator = Context->Format == djFORMAT_JSON;
+    if (HasTerminator)
+      _djWriteChar(Context, '\0');
+    
+    if (Context->Callback)
+      Context->Callback(Context, Context->Buffer, Context->Used);
+    else if (!Context->FixedBuffer || Context->Buffer == Context->FixedBuffer)
+      Result = Context->Buffer;
+  }
+  
+  if (LengthOut)
+    *LengthOut = (size_t)(Context->Flushed + Context->FixedUsed + Context->Overflow + Context->Used - HasTerminator);
+  return Result;
+}
+
+char* djWriteFinalize(dj_write_context* Context) {
+  char* Result = (char*)djWriteFinalizeWithLength(Context, 0);
+  if (Result && !Context->FixedBuffer)
+    Context->Buffer = 0; // The caller owns the string now
+  return Result;
+}
+
+void djWriteReset(dj_write_context* Context) {
+  assert(!Context->TargetFile && "File targets can't be reset. ");
+#ifdef DIR_JSON_ZLIB
+  assert(!Context->TargetGzipFile && "File targets can't be reset. ");
+#endif
+#ifdef DIR_JSON_MMAP
+  assert(!Context->IsMappedFile && "File targets can't be reset. ");
+#endif
+  
+  Context->Error          = 0;
+  Context->IsRootValue    = 1;
+  Context->Indention      = 0;
+  Context->ContextClue    = _dj_Context_Clue_First_Item;
+  Context->ContainerDepth = 0;
+  Context->IgnoredContainerDepth = 0;
+  Context->Used           = 0;
+  Context->Flushed        = 0;
+  Context->FixedUsed      = 0;
+  Context->Overflow       = 0;
+  
+  for (int Index = 0; Index < Context->SegmentCount; Index++) {
+    free(Context->Segments[Index].Data);
+  }
+  Context->SegmentCount = 0;
+  
+  if (Context->FixedBuffer) {
+    Context->Buffer = Context->FixedBuffer;
+    Context->Size   = Context->FixedSize;
+  } else if (!Context->Buffer) {
+    // The previous string was given to the caller by djWriteFinalize
+    Context->Buffer = malloc(Context->Size);
+    assert(Context->Buffer && "JSON: Out of memory. ");
+  }
+}
+
+void djWriteDestroyContext(dj_write_context* Context) {
+#ifdef DIR_JSON_MMAP
+  if (Context->IsMappedFile) {
+    if (Context->MapBase)
+      munmap(Context->MapBase, Context->MapSize);
+    if (Context->MappedFile >= 0) // Destroyed without being finalized
+      close(Context->MappedFile);
+    Context->Buffer = 0;
+  }
+#endif
+  if (!Context->FixedBuffer)
+    free(Context->Buffer);
+  for (int Index = 0; Index < Context->SegmentCount; Index++) {
+    free(Context->Segments[Index].Data);
+  }
+  free(Context->Segments);
+  free(Context);
+}
+
+const dj_segment* djWriteGetSegments(dj_write_context* Context, int* CountOut) {
+  assert(Context->IsSegmented && !Context->Buffer && "The segments are only available after djWriteFinalize. ");
+  *CountOut = Context->SegmentCount;
+  return Context->Segments;
+}
+
+char* djWriteJoinSegments(dj_write_context* Context, size_t* LengthOut) {
+  int SegmentCount;
+  const dj_segment* Segments = djWriteGetSegments(Context, &SegmentCount);
+  
+  char* Result = malloc(Context->Flushed + 1);
+  assert(Result && "JSON: Out of memory. ");
+  size_t Length = 0;
+  for (int Index = 0; Index < SegmentCount; Index++) {
+    memcpy(Result + Length, Segments[Index].Data, Segments[Index].Length);
+    Length += Segments[Index].Length;
   }
+  Result[Length] = '\0';
+  
+  if (LengthOut)
+    *LengthOut = Length;
+  return Result;
 }
 
-static void _djWriteChar(dj_write_context* Context, char Char) {
-  if (Context->Used == Context->Size) {
+dj_s64 djWriteRequiredSize(dj_write_context* Context) {
+  if (!Context->FixedBuffer || Context->Buffer == Context->FixedBuffer)
+    return Context->Used;
+  
+  // MessagePack reserves room for the largest header of a container until it's closed
+  dj_s64 Reserved = Context->Format == djFORMAT_MSGPACK ? 4 : 0;
+  return Context->FixedUsed + Context->Overflow + Context->Used + Reserved;
+}
+
+dj_write_stats djWriteGetStats(dj_write_context* Context) {
+  dj_write_stats Stats = { 0 };
+#ifdef DIR_JSON_STATS
+  Stats = Context->Stats;
+  Stats.BytesWritten += Context->Used;
+#else
+  (void)Context;
+#endif
+  return Stats;
+}
+
+// ===============================================================================
+// Binary Write Implementation
+// ===============================================================================
+
+// Makes sure Count bytes can be written without the buffer being flushed in between.
+static void _djReserveBytes(dj_write_context* Context, int Count) {
+  if (Context->Size - Context->Used < Count) {
     _djFlushBuffer(Context);
   }
-  Context->Buffer[Context->Used++] = Char;
+  if (Context->Size - Context->Used < Count) {
+    _DJ_STAT_ADD(Context, BufferReallocs, 1);
+    Context->Size = Context->Used + Count;
+    Context->Buffer = realloc(Context->Buffer, Context->Size);
+    assert(Context->Buffer);
+  }
 }
 
-static void _djWriteN(dj_write_context* Context, const char* Data, int Count) {
-  int AmountWritten = 0;
-  while (1) {
-    int AmountToWrite = min(Count - AmountWritten, Context->Size - Context->Used);
-    memcpy(Context->Buffer + Context->Used, Data + AmountWritten, AmountToWrite);
-    Context->Used += AmountToWrite;
-    AmountWritten += AmountToWrite;
-    if (AmountWritten == Count) {
-      break;
-    } else {
-      _djFlushBuffer(Context);
-    }
+static void _djWriteBigEndian(dj_write_context* Context, uint64_t Value, int ByteCount) {
+  char Bytes[8];
+  for (int ByteIndex = 0; ByteIndex < ByteCount; ByteIndex++) {
+    Bytes[ByteIndex] = (char)(Value >> (8 * (ByteCount - ByteIndex - 1)));
   }
+  _djWriteN(Context, Bytes, ByteCount);
 }
 
-static void _djWriteNewItem(dj_write_context* Context) {
-  if (Context->PrettyPrint) {
-    if (Context->IsRootValue) {
-      Context->IsRootValue = 0;
-    } else {
-      if (Context->ContextClue != _dj_Context_Clue_Member_Value) {
-        if (Context->ContextClue == _dj_Context_Clue_Write_Comma)
-          _djWriteChar(Context, ',');
-        _djWriteChar(Context, '\n');
-        int SpacesLeftToWrite = Context->Indention;
-        while (SpacesLeftToWrite > 0) {
-          int SpacesWritten = min(SpacesLeftToWrite, sizeof(_dj_Spaces_Array) - 1);
-          _djWriteN(Context, _dj_Spaces_Array, SpacesWritten);
-          SpacesLeftToWrite -= SpacesWritten;
-        }
-      } else {
-        _djWriteChar(Context, ' ');
-      }
-    }
+static void _djWriteCborHead(dj_write_context* Context, int MajorType, uint64_t Value) {
+  char Initial = (char)(MajorType << 5);
+  if (Value < 24) {
+    _djWriteChar(Context, Initial | (char)Value);
+  } else if (Value <= 0xFF) {
+    _djWriteChar(Context, Initial | 24);
+    _djWriteBigEndian(Context, Value, 1);
+  } else if (Value <= 0xFFFF) {
+    _djWriteChar(Context, Initial | 25);
+    _djWriteBigEndian(Context, Value, 2);
+  } else if (Value <= 0xFFFFFFFF) {
+    _djWriteChar(Context, Initial | 26);
+    _djWriteBigEndian(Context, Value, 4);
   } else {
-    switch (Context->ContextClue) {
-      case _dj_Context_Clue_First_Item: {
-      } break;
-      case _dj_Context_Clue_Member_Value: {
-      } break;
-      case _dj_Context_Clue_Write_Comma: {
-        _djWriteChar(Context, ',');
-      } break;
-    }
+    _djWriteChar(Context, Initial | 27);
+    _djWriteBigEndian(Context, Value, 8);
   }
-  Context->ContextClue = _dj_Context_Clue_Write_Comma;
 }
 
-static dj_write_context* _djCreateWriteContext(int BufferSize) {
-  dj_write_context* Context = calloc(1, sizeof(dj_write_context));
-  Context->ContextClue = _dj_Context_Clue_First_Item;
-  Context->IsRootValue = 1;
-  
-  Context->Size   = BufferSize > 0 ? BufferSize : 512;
-  Context->Buffer = malloc(Context->Size);
-  
-  return Context;
+// MessagePack containers are prefixed with their member count, array items are counted here and object members 
+// are counted when the key is written.
+static void _djBinaryWriteNewItem(dj_write_context* Context) {
+  if (Context->ContainerDepth > 0) {
+    _dj_write_container* Container = &Context->Containers[Context->ContainerDepth - 1];
+    if (!Container->IsObject)
+      Container->Count += 1;
+  }
 }
 
-dj_write_context* djWriteInitializeContextTargetString(int StartBufferSize) {
-  dj_write_context* Context = _djCreateWriteContext(StartBufferSize);
+static void _djBinaryStartContainer(dj_write_context* Context, int IsObject) {
+  _djBinaryWriteNewItem(Context);
   
-  Context->Size   = 128;
-  Context->Buffer = malloc(Context->Size);
+  if (Context->Format == djFORMAT_CBOR) {
+    _djWriteChar(Context, IsObject ? (char)0xBF : (char)0x9F); // Indefinite length map/array
+    return;
+  }
   
-  return Context;
+  if (Context->ContainerDepth == DIR_JSON_WRITE_MAX_DEPTH) {
+    // Nothing is written for the containers that are too deep, they are only counted so their ends are ignored
+    if (!Context->Error)
+      Context->Error = "Containers are nested too deeply. ";
+    Context->IgnoredContainerDepth += 1;
+    return;
+  }
+  
+  // Room is reserved for the largest header (map 32/array 32), it's shrunk when the container is closed
+  _djReserveBytes(Context, 5);
+  _dj_write_container* Container = &Context->Containers[Context->ContainerDepth++];
+  Container->Offset   = Context->Used;
+  Container->Count    = 0;
+  Container->IsObject = IsObject;
+  _djWriteChar(Context, IsObject ? (char)0xDF : (char)0xDD);
+  _djWriteBigEndian(Context, 0, 4);
 }
 
-dj_write_context* djWriteInitializeContextTargetFile(FILE* File, int BufferSize) {
-  dj_write_context* Context = _djCreateWriteContext(BufferSize);
+static void _djBinaryEndContainer(dj_write_context* Context) {
+  if (Context->Format == djFORMAT_CBOR) {
+    _djWriteChar(Context, (char)0xFF); // Break
+    return;
+  }
   
-  Context->TargetFile  = File;
+  if (Context->IgnoredContainerDepth) {
+    Context->IgnoredContainerDepth -= 1;
+    return;
+  }
   
-  return Context;
-}
-
-dj_write_context* djWriteInitializeContextTargetFilePath(const char* FilePath, int BufferSize) {
-  FILE* File = fopen(FilePath, "w");
+  assert(Context->ContainerDepth > 0 && "No container to end. ");
+  _dj_write_container* Container = &Context->Containers[--Context->ContainerDepth];
+  int Count = Container->Count;
+  int HeaderSize;
   
-  dj_write_context* Context = _djCreateWriteContext(BufferSize);
+  if (Context->Buffer == Context->Scratch) {
+    // The callers buffer has overflowed (or the file couldn't grow) so the output is only counted, the header might
+    // not even be in the buffer
+    HeaderSize = Count <= 15 ? 1 : Count <= 0xFFFF ? 3 : 5;
+    Context->Overflow -= 5 - HeaderSize;
+    return;
+  }
   
-  Context->TargetFile      = File;
-  Context->ShouldCloseFile = File != 0;
-  Context->Error           = File != 0 ? 0 : "Could not open file. ";
+  char* Header = Context->Buffer + Container->Offset;
+  if (Count <= 15) {
+    Header[0] = (char)((Container->IsObject ? 0x80 : 0x90) | Count);
+    HeaderSize = 1;
+  } else if (Count <= 0xFFFF) {
+    Header[0] = Container->IsObject ? (char)0xDE : (char)0xDC;
+    Header[1] = (char)(Count >> 8);
+    Header[2] = (char)(Count >> 0);
+    HeaderSize = 3;
+  } else {
+    Header[1] = (char)(Count >> 24);
+    Header[2] = (char)(Count >> 16);
+    Header[3] = (char)(Count >> 8);
+    Header[4] = (char)(Count >> 0);
+    HeaderSize = 5;
+  }
   
-  return Context;
+  if (HeaderSize != 5) {
+    memmove(Header + HeaderSize, Header + 5, Context->Used - Container->Offset - 5);
+    Context->Used -= 5 - HeaderSize;
+  }
 }
 
-dj_write_context* djWriteInitializeContextTargetCustom(dj_write_callback Callback, int BufferSize)  {
-  dj_write_context* Context = _djCreateWriteContext(BufferSize);
-  
-  Context->Callback = Callback;
-  
-  return Context;
+static void _djBinaryWriteString(dj_write_context* Context, const char* Str, size_t Length) {
+  if (Context->Format == djFORMAT_CBOR) {
+    _djWriteCborHead(Context, 3, Length);
+  } else if (Length < 32) {
+    _djWriteChar(Context, (char)(0xA0 | Length));
+  } else if (Length <= 0xFF) {
+    _djWriteChar(Context, (char)0xD9);
+    _djWriteBigEndian(Context, Length, 1);
+  } else if (Length <= 0xFFFF) {
+    _djWriteChar(Context, (char)0xDA);
+    _djWriteBigEndian(Context, Length, 2);
+  } else {
+    _djWriteChar(Context, (char)0xDB);
+    _djWriteBigEndian(Context, Length, 4);
+  }
+  _djWriteN(Context, Str, (int)Length);
 }
 
-void djWriteSetPrettyPrint(dj_write_context* Context, int ShouldPrettyPrint) {
-  Context->PrettyPrint = ShouldPrettyPrint;
+static void _djBinaryWriteKey(dj_write_context* Context, const char* Key, size_t Length) {
+  if (Context->ContainerDepth > 0) {
+    _dj_write_container* Container = &Context->Containers[Context->ContainerDepth - 1];
+    if (Container->IsObject)
+      Container->Count += 1;
+  }
+  _djBinaryWriteString(Context, Key, Length);
 }
 
-char* djWriteFinalize(dj_write_context* Context) {
-  char* Result = 0;
-  if (Context->TargetFile) {
-    _djFlushBuffer(Context);
-    if (Context->ShouldCloseFile) {
-      fclose(Context->TargetFile);
+static void _djBinaryWriteS64(dj_write_context* Context, dj_s64 Value) {
+  if (Context->Format == djFORMAT_CBOR) {
+    if (Value >= 0)
+      _djWriteCborHead(Context, 0, (uint64_t)Value);
+    else
+      _djWriteCborHead(Context, 1, (uint64_t)(-(Value + 1)));
+  } else if (Value >= 0) {
+    if (Value <= 0x7F) {
+      _djWriteChar(Context, (char)Value); // Positive fixint
+    } else if (Value <= 0xFF) {
+      _djWriteChar(Context, (char)0xCC);
+      _djWriteBigEndian(Context, Value, 1);
+    } else if (Value <= 0xFFFF) {
+      _djWriteChar(Context, (char)0xCD);
+      _djWriteBigEndian(Context, Value, 2);
+    } else if (Value <= 0xFFFFFFFF) {
+      _djWriteChar(Context, (char)0xCE);
+      _djWriteBigEndian(Context, Value, 4);
+    } else {
+      _djWriteChar(Context, (char)0xCF);
+      _djWriteBigEndian(Context, Value, 8);
     }
-  } else if (Context->Callback) {
-    _djWriteChar(Context, '\0');
-    Context->Callback(Context, Context->Buffer, Context->Used);
   } else {
-    _djWriteChar(Context, '\0');
-    Result = Context->Buffer;
-    Context->Buffer = 0;
+    if (Value >= -32) {
+      _djWriteChar(Context, (char)Value); // Negative fixint
+    } else if (Value >= -128) {
+      _djWriteChar(Context, (char)0xD0);
+      _djWriteBigEndian(Context, (uint64_t)Value, 1);
+    } else if (Value >= -32768) {
+      _djWriteChar(Context, (char)0xD1);
+      _djWriteBigEndian(Context, (uint64_t)Value, 2);
+    } else if (Value >= -2147483647LL - 1) {
+      _djWriteChar(Context, (char)0xD2);
+      _djWriteBigEndian(Context, (uint64_t)Value, 4);
+    } else {
+      _djWriteChar(Context, (char)0xD3);
+      _djWriteBigEndian(Context, (uint64_t)Value, 8);
+    }
   }
-  return Result;
 }
 
-void djWriteDestroyContext(dj_write_context* Context) {
-  free(Context->Buffer);
-  free(Context);
+static void _djBinaryWriteF64(dj_write_context* Context, dj_f64 Value) {
+  uint64_t Bits;
+  memcpy(&Bits, &Value, sizeof(Bits));
+  _djWriteChar(Context, Context->Format == djFORMAT_CBOR ? (char)0xFB : (char)0xCB);
+  _djWriteBigEndian(Context, Bits, 8);
 }
 
+// ===============================================================================
+// Write Functions
+// ===============================================================================
+
 void djWriteStartObject(dj_write_context* Context) {
+  if (Context->Format != djFORMAT_JSON) {
+    _djBinaryStartContainer(Context, 1);
+    return;
+  }
+  
   _djWriteNewItem(Context);
   
   _djWriteChar(Context, '{');
@@ -1264,13 +5424,30 @@ void djWriteStartObject(dj_write_context* Context) {
   Context->Indention += DIR_JSON_WRITE_INDENTION_SPACE_COUNT;
 }
 
-void djWriteKey(dj_write_context* Context, const char* Key) {
-  djWriteString(Context, Key);
+static void _djWriteStringN(dj_write_context* Context, const char* Str, size_t Length);
+
+// Same as djWriteKey for keys that aren't null terminated.
+static void _djWriteKeyN(dj_write_context* Context, const char* Key, size_t Length) {
+  if (Context->Format != djFORMAT_JSON) {
+    _djBinaryWriteKey(Context, Key, Length);
+    return;
+  }
+  
+  _djWriteStringN(Context, Key, Length);
   _djWriteChar(Context, ':');
   Context->ContextClue = _dj_Context_Clue_Member_Value;
 }
 
+void djWriteKey(dj_write_context* Context, const char* Key) {
+  _djWriteKeyN(Context, Key, strlen(Key));
+}
+
 void djWriteEndObject(dj_write_context* Context) {
+  if (Context->Format != djFORMAT_JSON) {
+    _djBinaryEndContainer(Context);
+    return;
+  }
+  
   Context->Indention -= DIR_JSON_WRITE_INDENTION_SPACE_COUNT;
   Context->ContextClue = _dj_Context_Clue_First_Item;
   _djWriteNewItem(Context);
@@ -1279,6 +5456,11 @@ void djWriteEndObject(dj_write_context* Context) {
 }
 
 void djWriteStartArray(dj_write_context* Context) {
+  if (Context->Format != djFORMAT_JSON) {
+    _djBinaryStartContainer(Context, 0);
+    return;
+  }
+  
   _djWriteNewItem(Context);
   
   _djWriteChar(Context, '[');
@@ -1287,6 +5469,11 @@ void djWriteStartArray(dj_write_context* Context) {
 }
 
 void djWriteEndArray(dj_write_context* Context) {
+  if (Context->Format != djFORMAT_JSON) {
+    _djBinaryEndContainer(Context);
+    return;
+  }
+  
   Context->Indention -= DIR_JSON_WRITE_INDENTION_SPACE_COUNT;
   Context->ContextClue = _dj_Context_Clue_First_Item;
   _djWriteNewItem(Context);
@@ -1295,6 +5482,15 @@ void djWriteEndArray(dj_write_context* Context) {
 }
 
 void djWriteBool(dj_write_context* Context, int Value) {
+  if (Context->Format != djFORMAT_JSON) {
+    _djBinaryWriteNewItem(Context);
+    if (Context->Format == djFORMAT_CBOR)
+      _djWriteChar(Context, Value ? (char)0xF5 : (char)0xF4);
+    else
+      _djWriteChar(Context, Value ? (char)0xC3 : (char)0xC2);
+    return;
+  }
+  
   _djWriteNewItem(Context);
   
   static const char TRUE_STR[]  = "true";
@@ -1306,6 +5502,12 @@ void djWriteBool(dj_write_context* Context, int Value) {
 }
 
 void djWriteS64(dj_write_context* Context, dj_s64 Value) {
+  if (Context->Format != djFORMAT_JSON) {
+    _djBinaryWriteNewItem(Context);
+    _djBinaryWriteS64(Context, Value);
+    return;
+  }
+  
   _djWriteNewItem(Context);
   
   char Buffer[32];
@@ -1327,6 +5529,12 @@ void djWriteS64(dj_write_context* Context, dj_s64 Value) {
 }
 
 void djWriteF64(dj_write_context* Context, dj_f64 Value) {
+  if (Context->Format != djFORMAT_JSON) {
+    _djBinaryWriteNewItem(Context);
+    _djBinaryWriteF64(Context, Value);
+    return;
+  }
+  
   _djWriteNewItem(Context);
   
   char Buffer[128];
@@ -1336,12 +5544,52 @@ void djWriteF64(dj_write_context* Context, dj_f64 Value) {
   _djWriteN(Context, Buffer, (int)Size);
 }
 
-void djWriteString(dj_write_context* Context, const char* Str) {
+void djWriteDecimal(dj_write_context* Context, dj_s64 Value, int Scale) {
+  assert(Scale >= 0 && Scale <= 18 && "The scale needs to be between 0 and 18. ");
+  
+  if (Context->Format != djFORMAT_JSON) {
+    _djBinaryWriteNewItem(Context);
+    if (Value % _dj_Powers_Of_Ten[Scale] == 0)
+      _djBinaryWriteS64(Context, Value / _dj_Powers_Of_Ten[Scale]);
+    else
+      _djBinaryWriteF64(Context, (dj_f64)Value / (dj_f64)_dj_Powers_Of_Ten[Scale]);
+    return;
+  }
+  
+  _djWriteNewItem(Context);
+  
+  char Buffer[32];
+  int BufferLeft = sizeof(Buffer);
+  uint64_t ValueIterator = Value < 0 ? 0 - (uint64_t)Value : (uint64_t)Value;
+  
+  // The digits are written backwards with the decimal point after Scale of them, at least one digit is in front of it
+  for (int Digits = 0; ValueIterator || Digits <= Scale; Digits++) {
+    if (Digits == Scale && Scale)
+      Buffer[--BufferLeft] = '.';
+    Buffer[--BufferLeft] = '0' + (char)(ValueIterator % 10);
+    ValueIterator /= 10;
+  }
+  
+  if (Value < 0) {
+    Buffer[--BufferLeft] = '-';
+  }
+  
+  _djWriteN(Context, Buffer + BufferLeft, sizeof(Buffer) - BufferLeft);
+}
+
+// Same as djWriteString for strings that aren't null terminated.
+static void _djWriteStringN(dj_write_context* Context, const char* Str, size_t Length) {
+  if (Context->Format != djFORMAT_JSON) {
+    _djBinaryWriteNewItem(Context);
+    _djBinaryWriteString(Context, Str, Length);
+    return;
+  }
+  
   _djWriteNewItem(Context);
   
   _djWriteChar(Context, '\"');
   
-  while (*Str) {
+  for (const char* End = Str + Length; Str < End; ++Str) {
     switch (*Str) {
       case '\"': _djWriteN(Context, "\\\"", 2); break;
       case '\\': _djWriteN(Context, "\\\\", 2); break;
@@ -1350,21 +5598,295 @@ void djWriteString(dj_write_context* Context, const char* Str) {
       case '\n': _djWriteN(Context, "\\n",  2); break;
       case '\r': _djWriteN(Context, "\\r",  2); break;
       case '\t': _djWriteN(Context, "\\t",  2); break;
-      default: _djWriteChar(Context, *Str);
+      default: {
+        unsigned char Char = (unsigned char)*Str;
+        if (Char < 0x20) {
+          // The remaining control characters don't have a short escape
+          char Escape[6] = { '\\', 'u', '0', '0', "0123456789abcdef"[Char >> 4], "0123456789abcdef"[Char & 0xF] };
+          _djWriteN(Context, Escape, 6);
+        } else {
+          _djWriteChar(Context, *Str);
+        }
+      }
     }
-    ++Str;
   }
   
   _djWriteChar(Context, '\"');
 }
 
+void djWriteString(dj_write_context* Context, const char* Str) {
+  _djWriteStringN(Context, Str, strlen(Str));
+}
+
 void djWriteNull(dj_write_context* Context) {
+  if (Context->Format != djFORMAT_JSON) {
+    _djBinaryWriteNewItem(Context);
+    _djWriteChar(Context, Context->Format == djFORMAT_CBOR ? (char)0xF6 : (char)0xC0);
+    return;
+  }
+  
   _djWriteNewItem(Context);
   
   static const char NULL_STR[] = "null";
   _djWriteN(Context, NULL_STR, sizeof(NULL_STR) - 1);
 }
 
+// ===============================================================================
+// Copy Implementation
+// ===============================================================================
+
+// Writes a value that is already formatted as json.
+static void _djWriteRaw(dj_write_context* Context, const char* Data, size_t Length) {
+  _djWriteNewItem(Context);
+  _djWriteN(Context, Data, (int)Length);
+}
+
+static int _djIsWhiteSpace(char Char) {
+  return Char == ' ' || Char == '\t' || Char == '\n' || Char == '\r';
+}
+
+// Returns the char after the closing quote of the string starting at Char, the string has already been scanned.
+static const char* _djSkipRawString(const char* Char, const char* End) {
+  Char += 1;
+  while (1) {
+    Char = _djFindQuoteOrBackslash(Char, End);
+    if (Char == End || *Char == '"')
+      return Char + (Char != End);
+    Char += 2; // The escaped char
+  }
+}
+
+// Copies json that has already been scanned, only the whitespace between the tokens is changed.
+static void _djCopyRawJson(dj_write_context* Output, const char* Char, const char* End) {
+  if (!Output->PrettyPrint) {
+    // Everything but the whitespace is copied in runs
+    _djWriteNewItem(Output);
+    const char* Run = Char;
+    while (Char < End) {
+      if (*Char == '"') {
+        Char = _djSkipRawString(Char, End);
+      } else if (_djIsWhiteSpace(*Char)) {
+        _djWriteN(Output, Run, (int)(Char - Run));
+        while (Char < End && _djIsWhiteSpace(*Char))
+          Char += 1;
+        Run = Char;
+      } else {
+        Char += 1;
+      }
+    }
+    _djWriteN(Output, Run, (int)(Char - Run));
+    return;
+  }
+  
+  // The containers goes through the writer so the indention and commas are the same as for any other value
+  while (Char < End) {
+    switch (*Char) {
+      case '{': djWriteStartObject(Output); Char += 1; break;
+      case '}': djWriteEndObject(Output);   Char += 1; break;
+      case '[': djWriteStartArray(Output);  Char += 1; break;
+      case ']': djWriteEndArray(Output);    Char += 1; break;
+      case ',': case ':': case ' ': case '\t': case '\n': case '\r': Char += 1; break;
+      case '"': {
+        const char* Start = Char;
+        Char = _djSkipRawString(Char, End);
+        const char* Next = Char;
+        while (Next < End && _djIsWhiteSpace(*Next))
+          Next += 1;
+        _djWriteRaw(Output, Start, Char - Start);
+        if (Next < End && *Next == ':') {
+          _djWriteChar(Output, ':');
+          Output->ContextClue = _dj_Context_Clue_Member_Value;
+        }
+      } break;
+      default: {
+        // Numbers, true, false and null
+        const char* Start = Char;
+        while (Char < End && !_djIsWhiteSpace(*Char) && *Char != ',' && *Char != ']' && *Char != '}')
+          Char += 1;
+        _djWriteRaw(Output, Start, Char - Start);
+      }
+    }
+  }
+}
+
+static void _djCopyValue(dj_read_context* Source, dj_write_context* Output, int Depth) {
+  if (Source->Format == djFORMAT_JSON && Output->Format == djFORMAT_JSON) {
+    // Nothing needs to be unescaped or converted, the structure is only checked to find the end
+    assert(Source->ShouldReadValueNext);
+    Source->ShouldReadValueNext = 0;
+    const char* Start = Source->CurrentChar;
+    const char* End   = _djScanStructure(Source, Start, 0);
+    if (End) {
+      _djCopyRawJson(Output, Start, End);
+      Source->CurrentChar = End;
+      _djEatWhiteSpaces(Source);
+    }
+    return;
+  }
+  
+  if (Depth == DIR_JSON_READ_MAX_DEPTH) {
+    djReadReportErrorIfNoErrorExists(Source, Source->CurrentChar, Source->CurrentChar + 1, 
+                                     "Containers are nested too deeply. ");
+    return;
+  }
+  
+  if (djReadNextIsObject(Source)) {
+    djWriteStartObject(Output);
+    dj_string Key;
+    while (djReadKey(Source, &Key)) {
+      _djWriteKeyN(Output, Key.Data, Key.Length);
+      _djCopyValue(Source, Output, Depth + 1);
+    }
+    djWriteEndObject(Output);
+  } else if (djReadNextIsArray(Source)) {
+    djWriteStartArray(Output);
+    while (djReadArray(Source)) {
+      _djCopyValue(Source, Output, Depth + 1);
+    }
+    djWriteEndArray(Output);
+  } else if (djReadNextIsString(Source)) {
+    dj_string String = djReadString(Source);
+    _djWriteStringN(Output, String.Data, String.Length);
+  } else if (djReadNextIsNumber(Source)) {
+    if (Output->Format == djFORMAT_JSON) {
+      // The number is copied as written so nothing is lost, e.g. integers that don't fit in 64 bits
+      dj_number Number = djReadNumberRaw(Source);
+      if (!Source->Error)
+        _djWriteRaw(Output, Number.Text.Data, Number.Text.Length);
+    } else if (_djReadNextIsFloat(Source)) {
+      djWriteF64(Output, djReadF64(Source));
+    } else {
+      djWriteS64(Output, djReadS64(Source));
+    }
+  } else if (djReadNextIsBool(Source)) {
+    djWriteBool(Output, djReadBool(Source));
+  } else if (djReadNextIsNull(Source)) {
+    djReadNull(Source);
+    djWriteNull(Output);
+  } else {
+    djReadReportErrorIfNoErrorExists(Source, Source->CurrentChar, Source->CurrentChar + 1, "Expected a value. ");
+  }
+}
+
+// Writes a value of the patch, null members are removed from objects since that is the result of merging them 
+// into a value that isn't an object. Arrays replaces the value as a whole so their elements are kept as they are.
+static void _djWriteTapeValue(dj_write_context* Output, dj_tape* Tape, size_t Index, int ShouldRemoveNulls) {
+  switch (djTapeType(Tape, Index)) {
+    case djTYPE_OBJECT: {
+      djWriteStartObject(Output);
+      for (size_t KeyIndex = djTapeChild(Tape, Index); KeyIndex; KeyIndex = djTapeNext(Tape, KeyIndex + 2)) {
+        if (ShouldRemoveNulls && djTapeType(Tape, KeyIndex + 2) == djTYPE_NULL)
+          continue;
+        dj_string Key = djTapeString(Tape, KeyIndex);
+        _djWriteKeyN(Output, Key.Data, Key.Length);
+        _djWriteTapeValue(Output, Tape, KeyIndex + 2, ShouldRemoveNulls);
+      }
+      djWriteEndObject(Output);
+    } break;
+    case djTYPE_ARRAY: {
+      djWriteStartArray(Output);
+      for (size_t Element = djTapeChild(Tape, Index); Element; Element = djTapeNext(Tape, Element)) {
+        _djWriteTapeValue(Output, Tape, Element, 0);
+      }
+      djWriteEndArray(Output);
+    } break;
+    case djTYPE_STRING: {
+      dj_string String = djTapeString(Tape, Index);
+      _djWriteStringN(Output, String.Data, String.Length);
+    } break;
+    case djTYPE_S64:
+    case djTYPE_F64: {
+      // Numbers are written as they were in the patch, converting them would round fractions and large exponents
+      dj_string Text = _djTapeNumberText(Tape, Index);
+      if (Output->Format == djFORMAT_JSON && Text.Length)
+        _djWriteRaw(Output, Text.Data, Text.Length);
+      else if (djTapeType(Tape, Index) == djTYPE_S64)
+        djWriteS64(Output, djTapeS64(Tape, Index));
+      else
+        djWriteF64(Output, djTapeF64(Tape, Index));
+    } break;
+    case djTYPE_BOOL: djWriteBool(Output, djTapeBool(Tape, Index)); break;
+    case djTYPE_NULL: djWriteNull(Output); break;
+  }
+}
+
+static void _djMergePatch(dj_read_context* Source, dj_tape* Patch, size_t PatchIndex, dj_write_context* Output, 
+                          int Depth) {
+  if (djTapeType(Patch, PatchIndex) != djTYPE_OBJECT) {
+    // Anything but an object replaces the value
+    djReadSkipValue(Source);
+    _djWriteTapeValue(Output, Patch, PatchIndex, 0);
+    return;
+  }
+  
+  if (Depth == DIR_JSON_READ_MAX_DEPTH) {
+    djReadReportErrorIfNoErrorExists(Source, Source->CurrentChar, Source->CurrentChar + 1, 
+                                     "Containers are nested too deeply. ");
+    return;
+  }
+  
+  // Keeps track of the members of the patch that has been merged with a member of the source
+  int MemberCount = 0;
+  for (size_t KeyIndex = djTapeChild(Patch, PatchIndex); KeyIndex; KeyIndex = djTapeNext(Patch, KeyIndex + 2))
+    MemberCount += 1;
+  char LocalIsMerged[64] = { 0 };
+  char* IsMerged = MemberCount <= (int)sizeof(LocalIsMerged) ? LocalIsMerged : calloc(MemberCount, 1);
+  assert(IsMerged && "JSON: Out of memory. ");
+  
+  djWriteStartObject(Output);
+  
+  if (djReadNextIsObject(Source)) {
+    dj_string Key;
+    while (djReadKey(Source, &Key)) {
+      int Member = 0;
+      size_t KeyIndex = djTapeChild(Patch, PatchIndex);
+      while (KeyIndex && !_djStringEqualsN(djTapeString(Patch, KeyIndex), Key)) {
+        KeyIndex = djTapeNext(Patch, KeyIndex + 2);
+        Member += 1;
+      }
+      
+      if (!KeyIndex) {
+        _djWriteKeyN(Output, Key.Data, Key.Length);
+        _djCopyValue(Source, Output, Depth + 1);
+      } else if (djTapeType(Patch, KeyIndex + 2) == djTYPE_NULL) {
+        IsMerged[Member] = 1;
+        djReadSkipValue(Source); // Removed by the patch
+      } else {
+        IsMerged[Member] = 1;
+        _djWriteKeyN(Output, Key.Data, Key.Length);
+        _djMergePatch(Source, Patch, KeyIndex + 2, Output, Depth + 1);
+      }
+    }
+  } else {
+    djReadSkipValue(Source); // Replaced by the patch object
+  }
+  
+  // The members that didn't exist in the source are added
+  int Member = 0;
+  for (size_t KeyIndex = djTapeChild(Patch, PatchIndex); KeyIndex; KeyIndex = djTapeNext(Patch, KeyIndex + 2)) {
+    if (!IsMerged[Member++] && djTapeType(Patch, KeyIndex + 2) != djTYPE_NULL) {
+      dj_string Key = djTapeString(Patch, KeyIndex);
+      _djWriteKeyN(Output, Key.Data, Key.Length);
+      _djWriteTapeValue(Output, Patch, KeyIndex + 2, 1);
+    }
+  }
+  
+  djWriteEndObject(Output);
+  
+  if (IsMerged != LocalIsMerged)
+    free(IsMerged);
+}
+
+int djCopyValue(dj_read_context* Source, dj_write_context* Output) {
+  _djCopyValue(Source, Output, 0);
+  return !Source->Error && !Output->Error;
+}
+
+int djMergePatch(dj_read_context* Source, dj_tape* Patch, dj_write_context* Output) {
+  _djMergePatch(Source, Patch, 1, Output, 0);
+  return !Source->Error && !Output->Error;
+}
+
 
 #endif // DIR_JSON_IMPLEMENTATION
 #endif // DIR_JSON_H
@@ -1,9 +1,677 @@
 
-#include <stdio.h>
+#define DIR_JSON_IMPLEMENTATION
+#include "../source/dirjson.h"
 
+#include <time.h>
+
+#define ArrayCount(Array) (sizeof(Array) / sizeof(Array[0]))
+
+// Usage: DirPerf [--repetitions N] [--scale N] [--json ResultPath]
+// Every benchmark is run once as warmup and then Repetitions times, the minimum and median times are reported.
+// With --json the results are also written as json so they can be compared between releases.
+
+static int Repetitions = 5;
+static int Scale = 1;
+
+static double GetSeconds() {
+  struct timespec Time;
+  timespec_get(&Time, TIME_UTC);
+  return (double)Time.tv_sec + (double)Time.tv_nsec * 1e-9;
+}
+
+// Deterministic pseudo random numbers so the corpora are the same between runs
+static unsigned int RandomState = 12345;
+static unsigned int Random(unsigned int Max) {
+  RandomState = RandomState * 1103515245 + 12345;
+  return (RandomState >> 8) % Max;
+}
+
+// Keeps the compiler from optimizing away the values that are read
+static volatile dj_s64 Sink;
+
+// ===============================================================================
+// Results
+// ===============================================================================
+
+typedef struct {
+  const char* Kind;
+  const char* Api;
+  const char* Corpus;
+  const char* Format;
+  size_t Bytes;
+  dj_s64 Values;
+  double MinSeconds;
+  double MedianSeconds;
+} result;
+
+static result Results[256];
+static int ResultCount;
+
+static int CompareDoubles(const void* A, const void* B) {
+  double Difference = *(const double*)A - *(const double*)B;
+  return (Difference > 0) - (Difference < 0);
+}
+
+static void AddResult(const char* Kind, const char* Api, const char* Corpus, const char* Format, size_t Bytes,
+                      dj_s64 Values, double* Times) {
+  qsort(Times, Repetitions, sizeof(double), CompareDoubles);
+
+  assert(ResultCount < ArrayCount(Results));
+  result* Result = &Results[ResultCount++];
+  Result->Kind          = Kind;
+  Result->Api           = Api;
+  Result->Corpus        = Corpus;
+  Result->Format        = Format;
+  Result->Bytes         = Bytes;
+  Result->Values        = Values;
+  Result->MinSeconds    = Times[0];
+  Result->MedianSeconds = Times[Repetitions / 2];
+
+  printf("%-5s %-10s %-16s %-7s %10.2f MB/s %8.2f ns/value (median %8.2f MB/s)\n", Kind, Api, Corpus, Format,
+         Bytes / Result->MinSeconds / (1024 * 1024), Result->MinSeconds * 1e9 / Values,
+         Bytes / Result->MedianSeconds / (1024 * 1024));
+}
+
+static void WriteResults(const char* FilePath) {
+  dj_write_context* Context = djWriteInitializeContextTargetFilePath(FilePath, 0);
+  djWriteSetPrettyPrint(Context, 1);
+
+  djWriteStartObject(Context);
+  djWriteKey(Context, "repetitions");
+  djWriteS64(Context, Repetitions);
+  djWriteKey(Context, "scale");
+  djWriteS64(Context, Scale);
+  djWriteKey(Context, "results");
+  djWriteStartArray(Context);
+  for (int ResultIndex = 0; ResultIndex < ResultCount; ResultIndex++) {
+    result* Result = &Results[ResultIndex];
+    djWriteStartObject(Context);
+    djWriteKey(Context, "kind");
+    djWriteString(Context, Result->Kind);
+    djWriteKey(Context, "api");
+    djWriteString(Context, Result->Api);
+    djWriteKey(Context, "corpus");
+    djWriteString(Context, Result->Corpus);
+    djWriteKey(Context, "format");
+    djWriteString(Context, Result->Format);
+    djWriteKey(Context, "bytes");
+    djWriteS64(Context, Result->Bytes);
+    djWriteKey(Context, "values");
+    djWriteS64(Context, Result->Values);
+    djWriteKey(Context, "min_seconds");
+    djWriteF64(Context, Result->MinSeconds);
+    djWriteKey(Context, "median_seconds");
+    djWriteF64(Context, Result->MedianSeconds);
+    djWriteKey(Context, "mb_per_second");
+    djWriteF64(Context, Result->Bytes / Result->MinSeconds / (1024 * 1024));
+    djWriteKey(Context, "ns_per_value");
+    djWriteF64(Context, Result->MinSeconds * 1e9 / Result->Values);
+    djWriteEndObject(Context);
+  }
+  djWriteEndArray(Context);
+  djWriteEndObject(Context);
+
+  djWriteFinalize(Context);
+  if (Context->Error)
+    printf("Failed to write results: %s\n", Context->Error);
+  djWriteDestroyContext(Context);
+}
+
+// ===============================================================================
+// Corpora
+// ===============================================================================
+
+typedef void (*generate_function)(dj_write_context* Context);
+
+typedef struct {
+  const char* Name;
+  const char* Format;
+  char* Data;
+  size_t Size;
+  int DataFormat;
+  dj_s64 ValueCount;
+} corpus;
+
+static const char* Words[] = { "the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog", "caf\xc3\xa9",
+                               "r\xc3\xa9sum\xc3\xa9", "json", "parser", "benchmark", "stream" };
+
+static void GenerateText(char* Text, int MaxLength, int WordCount, int UseEscapes) {
+  static const char* Escapes[] = { "\"", "\\", "\n", "\t", "\r", "/" };
+  int Length = 0;
+  for (int WordIndex = 0; WordIndex < WordCount; WordIndex++) {
+    const char* Word = Words[Random(ArrayCount(Words))];
+    int WordLength = (int)strlen(Word);
+    if (Length + WordLength + 2 >= MaxLength)
+      break;
+    if (WordIndex > 0)
+      Text[Length++] = UseEscapes ? Escapes[Random(ArrayCount(Escapes))][0] : ' ';
+    memcpy(Text + Length, Word, WordLength);
+    Length += WordLength;
+  }
+  Text[Length] = '\0';
+}
+
+static void GenerateTwitter(dj_write_context* Context) {
+  char Text[256];
+  djWriteStartArray(Context);
+  for (int TweetIndex = 0; TweetIndex < 20000 * Scale; TweetIndex++) {
+    djWriteStartObject(Context);
+    djWriteKey(Context, "id");
+    djWriteS64(Context, 1000000000000000000ll + TweetIndex * 7919ll);
+    djWriteKey(Context, "text");
+    GenerateText(Text, sizeof(Text), 5 + Random(20), 0);
+    djWriteString(Context, Text);
+    djWriteKey(Context, "user");
+    djWriteStartObject(Context);
+    djWriteKey(Context, "id");
+    djWriteS64(Context, Random(1000000));
+    djWriteKey(Context, "screen_name");
+    GenerateText(Text, sizeof(Text), 1, 0);
+    djWriteString(Context, Text);
+    djWriteKey(Context, "followers_count");
+    djWriteS64(Context, Random(100000));
+    djWriteKey(Context, "verified");
+    djWriteBool(Context, Random(10) == 0);
+    djWriteEndObject(Context);
+    djWriteKey(Context, "hashtags");
+    djWriteStartArray(Context);
+    int HashtagCount = Random(4);
+    for (int HashtagIndex = 0; HashtagIndex < HashtagCount; HashtagIndex++) {
+      GenerateText(Text, sizeof(Text), 1, 0);
+      djWriteString(Context, Text);
+    }
+    djWriteEndArray(Context);
+    djWriteKey(Context, "retweet_count");
+    djWriteS64(Context, Random(5000));
+    djWriteKey(Context, "favorited");
+    djWriteBool(Context, Random(2));
+    djWriteKey(Context, "coordinates");
+    if (Random(5) == 0) {
+      djWriteStartArray(Context);
+      djWriteF64(Context, Random(36000) / 100.0 - 180.0);
+      djWriteF64(Context, Random(18000) / 100.0 - 90.0);
+      djWriteEndArray(Context);
+    } else {
+      djWriteNull(Context);
+    }
+    djWriteKey(Context, "lang");
+    djWriteString(Context, Random(3) ? "en" : "sv");
+    djWriteEndObject(Context);
+  }
+  djWriteEndArray(Context);
+}
+
+static void GenerateNumeric(dj_write_context* Context) {
+  djWriteStartArray(Context);
+  for (int RowIndex = 0; RowIndex < 50000 * Scale; RowIndex++) {
+    djWriteStartArray(Context);
+    for (int ColumnIndex = 0; ColumnIndex < 8; ColumnIndex++) {
+      if (ColumnIndex & 1) {
+        djWriteF64(Context, (Random(2000000) - 1000000.0) / 1024.0);
+      } else {
+        djWriteS64(Context, (dj_s64)Random(1 << 30) * (Random(2) ? 1 : -1));
+      }
+    }
+    djWriteEndArray(Context);
+  }
+  djWriteEndArray(Context);
+}
+
+static void GenerateStrings(dj_write_context* Context) {
+  char Text[256];
+  djWriteStartArray(Context);
+  for (int StringIndex = 0; StringIndex < 100000 * Scale; StringIndex++) {
+    GenerateText(Text, sizeof(Text), 2 + Random(12), 1);
+    djWriteString(Context, Text);
+  }
+  djWriteEndArray(Context);
+}
+
+static void GenerateNestedLevel(dj_write_context* Context, int Depth) {
+  if (Depth == 0) {
+    djWriteS64(Context, Random(100));
+    return;
+  }
+
+  if (Depth & 1) {
+    djWriteStartObject(Context);
+    djWriteKey(Context, "value");
+    djWriteS64(Context, Depth);
+    djWriteKey(Context, "child");
+    GenerateNestedLevel(Context, Depth - 1);
+    djWriteEndObject(Context);
+  } else {
+    djWriteStartArray(Context);
+    djWriteBool(Context, 1);
+    GenerateNestedLevel(Context, Depth - 1);
+    djWriteEndArray(Context);
+  }
+}
+
+static void GenerateNested(dj_write_context* Context) {
+  djWriteStartArray(Context);
+  for (int TreeIndex = 0; TreeIndex < 5000 * Scale; TreeIndex++) {
+    GenerateNestedLevel(Context, 40);
+  }
+  djWriteEndArray(Context);
+}
+
+static char*  BinaryOutput;
+static size_t BinaryOutputSize;
+static void StoreBinaryOutputCallback(dj_write_context* Context, char* Data, int Size) {
+  BinaryOutput = realloc(BinaryOutput, BinaryOutputSize + Size);
+  memcpy(BinaryOutput + BinaryOutputSize, Data, Size);
+  BinaryOutputSize += Size;
+}
+
+static corpus GenerateCorpus(const char* Name, generate_function Function, int Format, int PrettyPrint) {
+  corpus Corpus = { Name, Format == djFORMAT_JSON ? (PrettyPrint ? "pretty" : "json") :
+                          Format == djFORMAT_MSGPACK ? "msgpack" : "cbor" };
+  Corpus.DataFormat = Format;
+
+  RandomState = 12345;
+  if (Format == djFORMAT_JSON) {
+    dj_write_context* Context = djWriteInitializeContextTargetString(0);
+    djWriteSetPrettyPrint(Context, PrettyPrint);
+    Function(Context);
+    Corpus.Data = djWriteFinalize(Context);
+    Corpus.Size = strlen(Corpus.Data);
+    djWriteDestroyContext(Context);
+  } else {
+    BinaryOutput = 0;
+    BinaryOutputSize = 0;
+    dj_write_context* Context = djWriteInitializeContextTargetCustom(StoreBinaryOutputCallback, 64 * 1024);
+    djWriteSetFormat(Context, Format);
+    Function(Context);
+    djWriteFinalize(Context);
+    djWriteDestroyContext(Context);
+    Corpus.Data = BinaryOutput;
+    Corpus.Size = BinaryOutputSize;
+  }
+  return Corpus;
+}
+
+// ===============================================================================
+// Read benchmarks
+// ===============================================================================
+
+typedef dj_s64 (*read_function)(dj_read_context* Context, dj_s64* ValueCount);
+
+// Reads any value by checking the type of each value, uses djReadKey for the objects
+static dj_s64 ReadGenericValue(dj_read_context* Context, dj_s64* ValueCount) {
+  dj_s64 Sum = 0;
+  *ValueCount += 1;
+  if (djReadNextIsObject(Context)) {
+    dj_string Key;
+    while (djReadKey(Context, &Key)) {
+      Sum += Key.Length;
+      Sum += ReadGenericValue(Context, ValueCount);
+    }
+  } else if (djReadNextIsArray(Context)) {
+    while (djReadArray(Context)) {
+      Sum += ReadGenericValue(Context, ValueCount);
+    }
+  } else if (djReadNextIsString(Context)) {
+    Sum += djReadString(Context).Length;
+  } else if (djReadNextIsNumber(Context)) {
+    Sum += (dj_s64)djReadF64(Context);
+  } else if (djReadNextIsBool(Context)) {
+    Sum += djReadBool(Context);
+  } else {
+    djReadNull(Context);
+  }
+  return Sum;
+}
+
+static dj_s64 ReadSkip(dj_read_context* Context, dj_s64* ValueCount) {
+  djReadSkipValue(Context);
+  return 0;
+}
+
+typedef struct {
+  dj_s64 Id;
+  dj_s64 UserId;
+  dj_s64 Followers;
+  dj_s64 Retweets;
+  int Verified;
+  int Favorited;
+  dj_string Text;
+  dj_s64 ValueCount;
+} tweet;
+
+static dj_callbacks_object* UserObject;
+static dj_callbacks_object* TweetObject;
+
+static void UnknownKeyCallback(dj_read_context* Context, void* Ptr, dj_string Key) {
+  djReadSkipValue(Context);
+}
+static void UserIdCallback(dj_read_context* Context, void* Ptr) {
+  ((tweet*)Ptr)->UserId = djReadS64(Context);
+}
+static void UserFollowersCallback(dj_read_context* Context, void* Ptr) {
+  ((tweet*)Ptr)->Followers = djReadS64(Context);
+}
+static void UserVerifiedCallback(dj_read_context* Context, void* Ptr) {
+  ((tweet*)Ptr)->Verified = djReadBool(Context);
+}
+static void TweetIdCallback(dj_read_context* Context, void* Ptr) {
+  ((tweet*)Ptr)->Id = djReadS64(Context);
+}
+static void TweetTextCallback(dj_read_context* Context, void* Ptr) {
+  ((tweet*)Ptr)->Text = djReadString(Context);
+}
+static void TweetUserCallback(dj_read_context* Context, void* Ptr) {
+  djReadObjectUsingCallbacks(Context, UserObject, Ptr);
+}
+static void TweetRetweetsCallback(dj_read_context* Context, void* Ptr) {
+  ((tweet*)Ptr)->Retweets = djReadS64(Context);
+}
+static void TweetFavoritedCallback(dj_read_context* Context, void* Ptr) {
+  ((tweet*)Ptr)->Favorited = djReadBool(Context);
+}
+
+static dj_s64 ReadTwitterCallbacks(dj_read_context* Context, dj_s64* ValueCount) {
+  dj_s64 Sum = 0;
+  tweet Tweet = { 0 };
+  while (djReadArray(Context)) {
+    djReadObjectUsingCallbacks(Context, TweetObject, &Tweet);
+    Sum += Tweet.Id + Tweet.UserId + Tweet.Followers + Tweet.Retweets + Tweet.Verified + Tweet.Favorited;
+  }
+  return Sum;
+}
+
+// The keys are expected in the order they are written
+static dj_s64 ReadTwitterMandatoryKeys(dj_read_context* Context, dj_s64* ValueCount) {
+  dj_s64 Sum = 0;
+  while (djReadArray(Context)) {
+    djReadMandatoryKey(Context, "id");
+    Sum += djReadS64(Context);
+    djReadMandatoryKey(Context, "text");
+    Sum += djReadString(Context).Length;
+    djReadMandatoryKey(Context, "user");
+    djReadMandatoryKey(Context, "id");
+    Sum += djReadS64(Context);
+    djReadMandatoryKey(Context, "screen_name");
+    Sum += djReadString(Context).Length;
+    djReadMandatoryKey(Context, "followers_count");
+    Sum += djReadS64(Context);
+    djReadMandatoryKey(Context, "verified");
+    Sum += djReadBool(Context);
+    djReadObjectEnd(Context);
+    djReadMandatoryKey(Context, "hashtags");
+    while (djReadArray(Context)) {
+      Sum += djReadString(Context).Length;
+    }
+    djReadMandatoryKey(Context, "retweet_count");
+    Sum += djReadS64(Context);
+    djReadMandatoryKey(Context, "favorited");
+    Sum += djReadBool(Context);
+    djReadMandatoryKey(Context, "coordinates");
+    if (djReadNextIsNull(Context)) {
+      djReadNull(Context);
+    } else {
+      while (djReadArray(Context)) {
+        Sum += (dj_s64)djReadF64(Context);
+      }
+    }
+    djReadMandatoryKey(Context, "lang");
+    Sum += djReadString(Context).Length;
+    djReadObjectEnd(Context);
+  }
+  return Sum;
+}
+
+static void BenchmarkRead(const char* Api, corpus* Corpus, read_function Function) {
+  double Times[64];
+  for (int RunIndex = -1; RunIndex < Repetitions; RunIndex++) {
+    double Start = GetSeconds();
+    dj_read_context* Context = Corpus->DataFormat == djFORMAT_JSON ? djReadFromString(Corpus->Data) :
+                               djReadFromBinary(Corpus->Data, Corpus->Size, Corpus->DataFormat);
+    dj_s64 ValueCount = 0;
+    Sink = Function(Context, &ValueCount);
+    djReadEOF(Context);
+    double Elapsed = GetSeconds() - Start;
+
+    if (djReadError(Context)) {
+      printf("%s %s %s: %s\n", Api, Corpus->Name, Corpus->Format, djReadError(Context));
+      djReadDestroyContext(Context);
+      return;
+    }
+    djReadDestroyContext(Context);
+
+    if (RunIndex >= 0)
+      Times[RunIndex] = Elapsed;
+  }
+  AddResult("read", Api, Corpus->Name, Corpus->Format, Corpus->Size, Corpus->ValueCount, Times);
+}
+
+static void BenchmarkValidate(corpus* Corpus) {
+  double Times[64];
+  for (int RunIndex = -1; RunIndex < Repetitions; RunIndex++) {
+    double Start = GetSeconds();
+    size_t ErrorOffset = 0;
+    int IsValid = djValidate(Corpus->Data, Corpus->Size, &ErrorOffset);
+    double Elapsed = GetSeconds() - Start;
+
+    if (!IsValid) {
+      printf("validate %s %s: invalid at %zu\n", Corpus->Name, Corpus->Format, ErrorOffset);
+      return;
+    }
+    if (RunIndex >= 0)
+      Times[RunIndex] = Elapsed;
+  }
+  AddResult("read", "validate", Corpus->Name, Corpus->Format, Corpus->Size, Corpus->ValueCount, Times);
+}
+
+// ===============================================================================
+// Write benchmarks
+// ===============================================================================
+
+// Returns the number of values written
+typedef dj_s64 (*write_function)(dj_write_context* Context);
+
+static size_t BytesWritten;
+static void CountBytesCallback(dj_write_context* Context, char* Data, int Size) {
+  BytesWritten += Size;
+}
+
+static dj_s64 WriteS64(dj_write_context* Context) {
+  int Count = 1000000 * Scale;
+  djWriteStartArray(Context);
+  for (int Index = 0; Index < Count; Index++)
+    djWriteS64(Context, (dj_s64)Index * Index * (Index & 1 ? 1 : -1));
+  djWriteEndArray(Context);
+  return Count + 1;
+}
+
+static dj_s64 WriteF64(dj_write_context* Context) {
+  int Count = 1000000 * Scale;
+  djWriteStartArray(Context);
+  for (int Index = 0; Index < Count; Index++)
+    djWriteF64(Context, Index * 1.0001);
+  djWriteEndArray(Context);
+  return Count + 1;
+}
+
+static dj_s64 WriteString(dj_write_context* Context) {
+  int Count = 1000000 * Scale;
+  djWriteStartArray(Context);
+  for (int Index = 0; Index < Count; Index++)
+    djWriteString(Context, Words[Index % ArrayCount(Words)]);
+  djWriteEndArray(Context);
+  return Count + 1;
+}
+
+static dj_s64 WriteStringEscaped(dj_write_context* Context) {
+  static const char* Strings[] = { "line\nbreak", "\"quoted\"", "back\\slash", "tab\tseparated" };
+  int Count = 1000000 * Scale;
+  djWriteStartArray(Context);
+  for (int Index = 0; Index < Count; Index++)
+    djWriteString(Context, Strings[Index % ArrayCount(Strings)]);
+  djWriteEndArray(Context);
+  return Count + 1;
+}
+
+static dj_s64 WriteBoolNull(dj_write_context* Context) {
+  int Count = 1000000 * Scale;
+  djWriteStartArray(Context);
+  for (int Index = 0; Index < Count; Index++) {
+    if (Index % 3 == 0) {
+      djWriteNull(Context);
+    } else {
+      djWriteBool(Context, Index & 1);
+    }
+  }
+  djWriteEndArray(Context);
+  return Count + 1;
+}
+
+static dj_s64 WriteObjects(dj_write_context* Context) {
+  int Count = 250000 * Scale;
+  djWriteStartArray(Context);
+  for (int Index = 0; Index < Count; Index++) {
+    djWriteStartObject(Context);
+    djWriteKey(Context, "id");
+    djWriteS64(Context, Index);
+    djWriteKey(Context, "name");
+    djWriteString(Context, Words[Index % ArrayCount(Words)]);
+    djWriteKey(Context, "score");
+    djWriteF64(Context, Index * 0.25);
+    djWriteKey(Context, "tags");
+    djWriteStartArray(Context);
+    djWriteBool(Context, Index & 1);
+    djWriteNull(Context);
+    djWriteEndArray(Context);
+    djWriteEndObject(Context);
+  }
+  djWriteEndArray(Context);
+  return Count * 7 + 1;
+}
+
+static void BenchmarkWrite(const char* Api, int Format, int PrettyPrint, write_function Function) {
+  const char* FormatName = Format == djFORMAT_JSON ? (PrettyPrint ? "pretty" : "json") :
+                           Format == djFORMAT_MSGPACK ? "msgpack" : "cbor";
+  double Times[64];
+  dj_s64 ValueCount = 0;
+  for (int RunIndex = -1; RunIndex < Repetitions; RunIndex++) {
+    BytesWritten = 0;
+    double Start = GetSeconds();
+    dj_write_context* Context = djWriteInitializeContextTargetCustom(CountBytesCallback, 64 * 1024);
+    djWriteSetFormat(Context, Format);
+    djWriteSetPrettyPrint(Context, PrettyPrint);
+    ValueCount = Function(Context);
+    djWriteFinalize(Context);
+    djWriteDestroyContext(Context);
+    double Elapsed = GetSeconds() - Start;
+
+    if (RunIndex >= 0)
+      Times[RunIndex] = Elapsed;
+  }
+  AddResult("write", Api, "generated", FormatName, BytesWritten, ValueCount, Times);
+}
+
+// ===============================================================================
+// Main
+// ===============================================================================
 
 int main(int argc, char* argv[]) {
-    printf("Performance is excellent!\n");
-    
-    return 0;
-}
\ No newline at end of file
+  const char* ResultPath = 0;
+  for (int ArgumentIndex = 1; ArgumentIndex < argc; ArgumentIndex++) {
+    if (strcmp(argv[ArgumentIndex], "--repetitions") == 0 && ArgumentIndex + 1 < argc) {
+      Repetitions = atoi(argv[++ArgumentIndex]);
+    } else if (strcmp(argv[ArgumentIndex], "--scale") == 0 && ArgumentIndex + 1 < argc) {
+      Scale = atoi(argv[++ArgumentIndex]);
+    } else if (strcmp(argv[ArgumentIndex], "--json") == 0 && ArgumentIndex + 1 < argc) {
+      ResultPath = argv[++ArgumentIndex];
+    } else {
+      printf("Usage: %s [--repetitions N] [--scale N] [--json ResultPath]\n", argv[0]);
+      return 1;
+    }
+  }
+  Repetitions = Repetitions < 1 ? 1 : Repetitions > 64 ? 64 : Repetitions;
+  Scale = Scale < 1 ? 1 : Scale;
+
+  dj_member UserMembers[] = {
+    { "id",              UserIdCallback,        djMANDATORY },
+    { "followers_count", UserFollowersCallback, djMANDATORY },
+    { "verified",        UserVerifiedCallback,  djOPTIONAL  },
+  };
+  dj_member TweetMembers[] = {
+    { "id",            TweetIdCallback,        djMANDATORY },
+    { "text",          TweetTextCallback,      djMANDATORY },
+    { "user",          TweetUserCallback,      djMANDATORY },
+    { "retweet_count", TweetRetweetsCallback,  djOPTIONAL  },
+    { "favorited",     TweetFavoritedCallback, djOPTIONAL  },
+  };
+  UserObject  = djInitializeObject(UserMembers,  ArrayCount(UserMembers),  UnknownKeyCallback);
+  TweetObject = djInitializeObject(TweetMembers, ArrayCount(TweetMembers), UnknownKeyCallback);
+
+  struct {
+    const char* Name;
+    generate_function Function;
+  } Generators[] = {
+    { "twitter", GenerateTwitter },
+    { "numeric", GenerateNumeric },
+    { "strings", GenerateStrings },
+    { "nested",  GenerateNested  },
+  };
+
+  corpus Corpora[ArrayCount(Generators) * 4];
+  int CorpusCount = 0;
+  for (int GeneratorIndex = 0; GeneratorIndex < ArrayCount(Generators); GeneratorIndex++) {
+    const char* Name = Generators[GeneratorIndex].Name;
+    generate_function Function = Generators[GeneratorIndex].Function;
+    Corpora[CorpusCount++] = GenerateCorpus(Name, Function, djFORMAT_JSON,    0);
+    Corpora[CorpusCount++] = GenerateCorpus(Name, Function, djFORMAT_JSON,    1);
+    Corpora[CorpusCount++] = GenerateCorpus(Name, Function, djFORMAT_MSGPACK, 0);
+    Corpora[CorpusCount++] = GenerateCorpus(Name, Function, djFORMAT_CBOR,    0);
+  }
+
+  printf("Repetitions: %d, scale: %d\n", Repetitions, Scale);
+  for (int CorpusIndex = 0; CorpusIndex < CorpusCount; CorpusIndex++) {
+    corpus* Corpus = &Corpora[CorpusIndex];
+
+    // Counts the values so ns/value can be reported for the other apis
+    dj_read_context* Context = Corpus->DataFormat == djFORMAT_JSON ? djReadFromString(Corpus->Data) :
+                               djReadFromBinary(Corpus->Data, Corpus->Size, Corpus->DataFormat);
+    ReadGenericValue(Context, &Corpus->ValueCount);
+    djReadDestroyContext(Context);
+
+    BenchmarkRead("generic", Corpus, ReadGenericValue);
+    BenchmarkRead("skip",    Corpus, ReadSkip);
+    if (Corpus->DataFormat == djFORMAT_JSON)
+      BenchmarkValidate(Corpus);
+    if (strcmp(Corpus->Name, "twitter") == 0) {
+      BenchmarkRead("keys",      Corpus, ReadTwitterMandatoryKeys);
+      BenchmarkRead("callbacks", Corpus, ReadTwitterCallbacks);
+    }
+  }
+
+  struct {
+    const char* Name;
+    write_function Function;
+  } Writers[] = {
+    { "s64",      WriteS64           },
+    { "f64",      WriteF64           },
+    { "string",   WriteString        },
+    { "escaped",  WriteStringEscaped },
+    { "boolnull", WriteBoolNull      },
+    { "objects",  WriteObjects       },
+  };
+  for (int WriterIndex = 0; WriterIndex < ArrayCount(Writers); WriterIndex++) {
+    BenchmarkWrite(Writers[WriterIndex].Name, djFORMAT_JSON,    0, Writers[WriterIndex].Function);
+    BenchmarkWrite(Writers[WriterIndex].Name, djFORMAT_JSON,    1, Writers[WriterIndex].Function);
+    BenchmarkWrite(Writers[WriterIndex].Name, djFORMAT_MSGPACK, 0, Writers[WriterIndex].Function);
+    BenchmarkWrite(Writers[WriterIndex].Name, djFORMAT_CBOR,    0, Writers[WriterIndex].Function);
+  }
+
+  if (ResultPath)
+    WriteResults(ResultPath);
+
+  for (int CorpusIndex = 0; CorpusIndex < CorpusCount; CorpusIndex++)
+    free(Corpora[CorpusIndex].Data);
+  djDestroyObject(UserObject);
+  djDestroyObject(TweetObject);
+
+  return 0;
+}
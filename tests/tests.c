@@ -26,6 +26,19 @@ typedef struct {
   void (*Function)(dj_read_context* Context);
 } test_success;
 
+typedef struct {
+  const char* Json;
+  int ErrorOffset; // -1 if valid
+} test_validate;
+
+typedef struct {
+  const char* Name;
+  int Format;
+  const char* Expected;
+  int ExpectedSize;
+  void (*Function)(dj_write_context* Context);
+} test_write;
+
 static const char TestReadExpectedArray__Json[]    = "123";
 static const char TestReadExpectedArray__Carrot[]  = "^  ";
 static const char TestReadExpectedArray__Message[] = "Expected an array. ";
@@ -61,6 +74,16 @@ void TestReadS64NegativeExponent(dj_read_context* Context) {
   djReadS64(Context);
 }
 
+static const char TestReadMultipleLines__Json[]    = "{\n  \"a\": 1,\n  \"b\": nul }";
+static const char TestReadMultipleLines__Carrot[]  = "       ^    ";
+static const char TestReadMultipleLines__Message[] = "Expected 'null'. ";
+void TestReadMultipleLines(dj_read_context* Context) {
+  djReadMandatoryKey(Context, "a");
+  djReadS64(Context);
+  djReadMandatoryKey(Context, "b");
+  djReadNull(Context);
+}
+
 static const char TestReadS64EmptyExponent__Json[]    = "123e";
 static const char TestReadS64EmptyExponent__Carrot[]  = "    ^";
 static const char TestReadS64EmptyExponent__Message[] = "The exponent needs to contain atleast one digit (0-9). ";
@@ -89,6 +112,29 @@ void TestReadF64EmptyExponent(dj_read_context* Context) {
   djReadF64(Context);
 }
 
+// Only the json number is converted, strtod would read the rest as a hex float
+static const char TestReadF64Hex__Json[]    = "0x1234";
+static const char TestReadF64Hex__Carrot[]  = " ^    ";
+static const char TestReadF64Hex__Message[] = "Unexpected content at end of file. ";
+void TestReadF64Hex(dj_read_context* Context) {
+  EXPECT_TRUE(djReadF64(Context) == 0);
+  djReadEOF(Context);
+}
+
+static const char TestReadDecimalTooManyDecimals__Json[]    = "12.345";
+static const char TestReadDecimalTooManyDecimals__Carrot[]  = "^^^^^^";
+static const char TestReadDecimalTooManyDecimals__Message[] = "The number has more decimals than the scale allows. ";
+void TestReadDecimalTooManyDecimals(dj_read_context* Context) {
+  djReadDecimal(Context, 2);
+}
+
+static const char TestReadDecimalOverflow__Json[]    = "92233720368547758.08";
+static const char TestReadDecimalOverflow__Carrot[]  = "^^^^^^^^^^^^^^^^^^^^";
+static const char TestReadDecimalOverflow__Message[] = "The number doesn't fit in 64 bits with the given scale. ";
+void TestReadDecimalOverflow(dj_read_context* Context) {
+  djReadDecimal(Context, 2);
+}
+
 static const char TestReadStringNotAString__Json[]    = "'Hello, world!'";
 static const char TestReadStringNotAString__Carrot[]  = "^              ";
 static const char TestReadStringNotAString__Message[] = "Expected a string. ";
@@ -103,13 +149,29 @@ void TestReadStringTooFewHex(dj_read_context* Context) {
   djReadString(Context);
 }
 
-static const char TestReadStringTooBigUnicode__Json[]    = "\"Hello\\u2001, world!\"";
-static const char TestReadStringTooBigUnicode__Carrot[]  = "        ^^^^         ";
-static const char TestReadStringTooBigUnicode__Message[] = "Given unicode was to large. ";
-void TestReadStringTooBigUnicode(dj_read_context* Context) {
+static const char TestReadStringLoneHighSurrogate__Json[]    = "\"Hello\\uD83D, world!\"";
+static const char TestReadStringLoneHighSurrogate__Carrot[]  = "      ^^^^^^         ";
+static const char TestReadStringLoneHighSurrogate__Message[] = "A high surrogate needs to be followed by a low surrogate. ";
+void TestReadStringLoneHighSurrogate(dj_read_context* Context) {
+  djReadString(Context);
+}
+
+static const char TestReadStringLoneLowSurrogate__Json[]    = "\"Hello\\uDC01, world!\"";
+static const char TestReadStringLoneLowSurrogate__Carrot[]  = "      ^^^^^^         ";
+static const char TestReadStringLoneLowSurrogate__Message[] = "A low surrogate needs to be preceded by a high surrogate. ";
+void TestReadStringLoneLowSurrogate(dj_read_context* Context) {
   djReadString(Context);
 }
 
+#ifdef DIR_JSON_VALIDATE_UTF8
+static const char TestReadStringInvalidUtf8__Json[]    = "\"Hello \xc3\x28 world!\"";
+static const char TestReadStringInvalidUtf8__Carrot[]  = "       ^         ";
+static const char TestReadStringInvalidUtf8__Message[] = "Invalid UTF-8 in string. ";
+void TestReadStringInvalidUtf8(dj_read_context* Context) {
+  djReadString(Context);
+}
+#endif
+
 static const char TestReadStringIllegalEscapeSequence__Json[]    = "\"Hello\\h, world!\"";
 static const char TestReadStringIllegalEscapeSequence__Carrot[]  = "       ^         ";
 static const char TestReadStringIllegalEscapeSequence__Message[] = "Unrecognised escape character. ";
@@ -177,6 +239,71 @@ void TestReadArray(dj_read_context* Context) {
   EXPECT_TRUE(djReadArray(Context) == 0);
 }
 
+static const char TestReadStringUnicode__Json[] = 
+  "[ \"A\\u00e9\\u20AC\\ud83d\\ude00\", \"a long string without any escapes, \\\"then\\\" an escape\\n\", \"\xc3\xa5\" ]";
+void TestReadStringUnicode(dj_read_context* Context) {
+  EXPECT_TRUE(djReadArray(Context) == 1);
+  EXPECT_TRUE(strcmp(djReadString(Context).Data, "A\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80") == 0);
+  EXPECT_TRUE(djReadArray(Context) == 1);
+  EXPECT_TRUE(strcmp(djReadString(Context).Data, "a long string without any escapes, \"then\" an escape\n") == 0);
+  EXPECT_TRUE(djReadArray(Context) == 1);
+  EXPECT_TRUE(strcmp(djReadString(Context).Data, "\xc3\xa5") == 0);
+  EXPECT_TRUE(djReadArray(Context) == 0);
+}
+
+static const char TestReadDecimal__Json[] = 
+  "[ 12.5, -0.05, 7, 1.50e1, 125e-1, 0.000, 0e400, -92233720368547758.08, 0.10000000000000000000000 ]";
+void TestReadDecimal(dj_read_context* Context) {
+  dj_s64 Expected[] = { 1250, -5, 700, 1500, 1250, 0, 0, INT64_MIN, 10 };
+  for (int Index = 0; Index < ArrayCount(Expected); Index++) {
+    EXPECT_TRUE(djReadArray(Context) == 1);
+    EXPECT_TRUE(djReadDecimal(Context, 2) == Expected[Index]);
+  }
+  EXPECT_TRUE(djReadArray(Context) == 0);
+}
+
+static const char TestReadNumberRaw__Json[] = "[ 12345678901234567890123, -0.0015, 1E+2, 2.50e-3 ]";
+void TestReadNumberRaw(dj_read_context* Context) {
+  const char* Texts[] = { "12345678901234567890123", "-0.0015", "1E+2", "2.50e-3" };
+  int Flags[]  = { djNUMBER_INTEGER, djNUMBER_FRACTION, djNUMBER_EXPONENT, djNUMBER_FRACTION | djNUMBER_EXPONENT };
+  int Digits[] = { 23, 2, 1, 3 };
+  for (int Index = 0; Index < ArrayCount(Texts); Index++) {
+    EXPECT_TRUE(djReadArray(Context) == 1);
+    dj_number Number = djReadNumberRaw(Context);
+    EXPECT_TRUE(Number.Text.Length == strlen(Texts[Index]));
+    EXPECT_TRUE(memcmp(Number.Text.Data, Texts[Index], Number.Text.Length) == 0);
+    EXPECT_TRUE(Number.Flags == Flags[Index] && Number.Digits == Digits[Index]);
+    EXPECT_TRUE(Number.IsNegative == (Index == 1));
+  }
+  EXPECT_TRUE(djReadArray(Context) == 0);
+}
+
+static const char TestReadKeyIds__Json[] = 
+  "{ \"x\": 1, \"unknown\": [ 2 ], \"\\u0079\": 3, \"z\": 4, \"x\": 5 }";
+void TestReadKeyIds(dj_read_context* Context) {
+  enum { KEY_X, KEY_Y, KEY_Z };
+  const char* Keys[] = { "x", "y", "z" };
+  dj_key_dictionary* Dictionary = djInitializeKeyDictionary(Keys, ArrayCount(Keys));
+  djReadSetKeyDictionary(Context, Dictionary);
+  
+  int Id;
+  EXPECT_TRUE(djReadMandatoryKeyId(Context, KEY_X));
+  EXPECT_TRUE(djReadS64(Context) == 1);
+  EXPECT_TRUE(djReadKeyId(Context, &Id) && Id == -1);
+  djReadSkipValue(Context);
+  EXPECT_TRUE(djReadKeyId(Context, &Id) && Id == KEY_Y);
+  EXPECT_TRUE(djReadS64(Context) == 3);
+  EXPECT_TRUE(!djReadOptionalKeyId(Context, KEY_Y));
+  EXPECT_TRUE(djReadOptionalKeyId(Context, KEY_Z));
+  EXPECT_TRUE(djReadS64(Context) == 4);
+  dj_string Key;
+  EXPECT_TRUE(!djReadOptionalKeyId(Context, KEY_Y) && djReadKey(Context, &Key) && strcmp(Key.Data, "x") == 0);
+  EXPECT_TRUE(djReadS64(Context) == 5);
+  EXPECT_TRUE(!djReadKeyId(Context, &Id));
+  
+  djDestroyKeyDictionary(Dictionary);
+}
+
 static const char TestReadNestedArrays__Json[] = "  [ [ 1 ] , [] , [ 2, 3 ] ]";
 void TestReadNestedArrays(dj_read_context* Context) {
   EXPECT_TRUE(djReadArray(Context) == 1);
@@ -200,6 +327,280 @@ void TestReadNestedArrays(dj_read_context* Context) {
   EXPECT_TRUE(djReadArray(Context) == 0);
 }
 
+static const char TestReadSkipValue__Json[] = " [ { \"a\": [ 1, \"]}\\\"\" ], \"b\": {} }, -12.5e3, \"x\", null, 7 ]";
+void TestReadSkipValue(dj_read_context* Context) {
+  EXPECT_TRUE(djReadArray(Context) == 1);
+  djReadSkipValue(Context);
+  EXPECT_TRUE(djReadArray(Context) == 1);
+  djReadSkipValue(Context);
+  EXPECT_TRUE(djReadArray(Context) == 1);
+  djReadSkipValue(Context);
+  EXPECT_TRUE(djReadArray(Context) == 1);
+  djReadSkipValue(Context);
+  EXPECT_TRUE(djReadArray(Context) == 1);
+  EXPECT_TRUE(djReadS64(Context) == 7);
+  EXPECT_TRUE(djReadArray(Context) == 0);
+}
+
+static const char TestReadColumns__Json[] = "[ { \"ts\": 1, \"v\": 0.5, \"name\": \"a\" },"
+                                           "  { \"v\": null, \"skip\": { \"x\": [1, 2] }, \"ts\": 2 },"
+                                           "  { \"name\": \"bc\", \"ts\": 3, \"ok\": true } ]";
+void TestReadColumns(dj_read_context* Context) {
+  dj_column_member Members[] = {
+    { "ts",   djCOLUMN_S64 },
+    { "v",    djCOLUMN_F64 },
+    { "name", djCOLUMN_STRING },
+    { "ok",   djCOLUMN_BOOL },
+  };
+  dj_columns_object* Columns = djInitializeColumns(Members, ArrayCount(Members));
+  
+  EXPECT_TRUE(djReadColumns(Context, Columns) == 3);
+  
+  const dj_column* Ts = djGetColumn(Columns, 0);
+  EXPECT_TRUE(Ts->Count == 3);
+  EXPECT_TRUE(((dj_s64*)Ts->Values)[0] == 1 && ((dj_s64*)Ts->Values)[1] == 2 && ((dj_s64*)Ts->Values)[2] == 3);
+  EXPECT_TRUE(Ts->NullBits[0] == 0 && Ts->MissingBits[0] == 0);
+  
+  const dj_column* V = djGetColumn(Columns, 1);
+  EXPECT_TRUE(((dj_f64*)V->Values)[0] == 0.5);
+  EXPECT_TRUE(V->NullBits[0] == 2 && V->MissingBits[0] == 4);
+  
+  const dj_column* Name = djGetColumn(Columns, 2);
+  size_t* Offsets = (size_t*)Name->Values;
+  EXPECT_TRUE(Offsets[0] == 0 && Offsets[1] == 1 && Offsets[2] == 1 && Offsets[3] == 3);
+  EXPECT_TRUE(memcmp(Name->StringData, "abc", 3) == 0);
+  EXPECT_TRUE(Name->MissingBits[0] == 2);
+  
+  const dj_column* Ok = djGetColumn(Columns, 3);
+  EXPECT_TRUE(((char*)Ok->Values)[2] == 1 && Ok->MissingBits[0] == 3);
+  
+  djDestroyColumns(Columns);
+}
+
+static const char TestReadTapeLargeIntegers__Json[] = "[ 9223372036854775807, 9223372036854775808, "
+                                                     "-9223372036854775808, 12345678901234567890 ]";
+void TestReadTapeLargeIntegers(dj_read_context* Context) {
+  dj_tape* Tape = djReadTape(Context);
+  EXPECT_TRUE(Tape != 0);
+  if (Tape) {
+    // Integers that don't fit in 64 bits are stored as floats instead of wrapping around
+    size_t Max = djTapeElement(Tape, 1, 0);
+    EXPECT_TRUE(djTapeType(Tape, Max) == djTYPE_S64 && djTapeS64(Tape, Max) == 9223372036854775807LL);
+    size_t AboveMax = djTapeElement(Tape, 1, 1);
+    EXPECT_TRUE(djTapeType(Tape, AboveMax) == djTYPE_F64 && djTapeF64(Tape, AboveMax) == 9223372036854775808.0);
+    size_t Min = djTapeElement(Tape, 1, 2);
+    EXPECT_TRUE(djTapeType(Tape, Min) == djTYPE_F64 && djTapeF64(Tape, Min) == -9223372036854775808.0);
+    size_t Large = djTapeElement(Tape, 1, 3);
+    EXPECT_TRUE(djTapeType(Tape, Large) == djTYPE_F64 && djTapeF64(Tape, Large) == 12345678901234567890.0);
+    EXPECT_TRUE(djTapeS64(Tape, Large) == 0 && djTapeS64(Tape, Min) == -9223372036854775807LL - 1);
+    djDestroyTape(Tape);
+  }
+}
+
+static const char TestReadTape__Json[] = "{ \"skip\": [ 1, [ 2 ], { } ], "
+                                        "\"obj\": { \"a\": 1, \"b\\n\": \"x\\ty\", \"c\": [ true, null, 2.5, [] ] }, "
+                                        "\"last\": 3 }";
+void TestReadTape(dj_read_context* Context) {
+  EXPECT_TRUE(djReadMandatoryKey(Context, "skip") == 1);
+  djReadSkipValue(Context);
+  EXPECT_TRUE(djReadMandatoryKey(Context, "obj") == 1);
+  
+  dj_tape* Tape = djReadTape(Context);
+  EXPECT_TRUE(Tape != 0);
+  if (Tape) {
+    EXPECT_TRUE(djTapeType(Tape, 1) == djTYPE_OBJECT);
+    EXPECT_TRUE(djTapeCount(Tape, 1) == 3);
+    EXPECT_TRUE(djTapeNext(Tape, 1) == 0);
+    
+    size_t C = djTapeFindKey(Tape, 1, "c");
+    EXPECT_TRUE(djTapeType(Tape, C) == djTYPE_ARRAY && djTapeCount(Tape, C) == 4);
+    EXPECT_TRUE(djTapeBool(Tape, djTapeElement(Tape, C, 0)) == 1);
+    EXPECT_TRUE(djTapeType(Tape, djTapeElement(Tape, C, 1)) == djTYPE_NULL);
+    EXPECT_TRUE(djTapeF64(Tape, djTapeElement(Tape, C, 2)) == 2.5);
+    EXPECT_TRUE(djTapeChild(Tape, djTapeElement(Tape, C, 3)) == 0);
+    EXPECT_TRUE(djTapeElement(Tape, C, 4) == 0);
+    
+    // Looked up in reverse order to make sure everything stays accessible
+    size_t B = djTapeFindKey(Tape, 1, "b\n");
+    dj_string String = djTapeString(Tape, B);
+    EXPECT_TRUE(String.Length == 3 && memcmp(String.Data, "x\ty", 3) == 0);
+    EXPECT_TRUE(djTapeS64(Tape, djTapeFindKey(Tape, 1, "a")) == 1);
+    EXPECT_TRUE(djTapeFindKey(Tape, 1, "d") == 0);
+    
+    djDestroyTape(Tape);
+  }
+  
+  EXPECT_TRUE(djReadMandatoryKey(Context, "last") == 1);
+  EXPECT_TRUE(djReadS64(Context) == 3);
+  EXPECT_TRUE(djReadObjectEnd(Context) == 1);
+}
+
+static const char TestReadSeekPath__Json[] = "{ \"meta\": { \"x\": [ 1, { \"a\": 2 } ], \"rou~te/s\": { \"shard\": 7 } }, "
+                                            "\"a\\nb\": [ 10, 20, { \"k\": \"v\" } ] }";
+void TestReadSeekPath(dj_read_context* Context) {
+  dj_string Key;
+  EXPECT_TRUE(djReadSeekPath(Context, "/meta/rou~0te~1s/shard") == 1);
+  EXPECT_TRUE(djReadS64(Context) == 7);
+  EXPECT_TRUE(djReadKey(Context, &Key) == 0);
+  EXPECT_TRUE(djReadKey(Context, &Key) == 0);
+  
+  // Continues relative to the current position, the next value is the root object's next member
+  EXPECT_TRUE(djReadKey(Context, &Key) == 1);
+  EXPECT_TRUE(djReadSeekPath(Context, "/2/k") == 1);
+  EXPECT_TRUE(strcmp(djReadString(Context).Data, "v") == 0);
+  EXPECT_TRUE(djReadKey(Context, &Key) == 0);
+  EXPECT_TRUE(djReadArray(Context) == 0);
+  EXPECT_TRUE(djReadKey(Context, &Key) == 0);
+}
+
+static const char TestReadSeekPathMissing__Json[] = "{ \"list\": [ 10, 20 ], \"b\": { \"c\": 1 }, \"d\": true }";
+void TestReadSeekPathMissing(dj_read_context* Context) {
+  EXPECT_TRUE(djReadSeekPath(Context, "/list/5") == 0);
+  EXPECT_TRUE(djReadMandatoryKey(Context, "b") == 1);
+  EXPECT_TRUE(djReadSeekPath(Context, "/x") == 0);
+  EXPECT_TRUE(djReadMandatoryKey(Context, "d") == 1);
+  EXPECT_TRUE(djReadSeekPath(Context, "") == 1);
+  EXPECT_TRUE(djReadBool(Context) == 1);
+  EXPECT_TRUE(djReadObjectEnd(Context) == 1);
+}
+
+static const char TestReadProjection__Json[] = 
+  "{ \"id\": 1, \"user\": { \"name\": \"a\\\"b\", \"tags\": [ \"x\", \"y\" ] }, \"extra\": [ 1, { \"z\": 3 } ], \"n\": null }\n"
+  "{ \"user\": { \"name\": \"c\" }, \"id\": 2.5, \"odd~key/\": true }\n"
+  "[ 1 ]\n"
+  "{ \"id\": 3, \"user\": { \"name\": \"e\", \"tags\": [ 0, \"t\", 2 ] }, \"n\": 0, \"odd~key/\": false, \"rest\": [ [ { } ] ] }\n";
+void TestReadProjection(dj_read_context* Context) {
+  const char* Paths[] = { "/id", "/user/name", "/user/tags/1", "/n", "/odd~0key~1", "/user" };
+  dj_projection* Projection = djInitializeProjection(Paths, ArrayCount(Paths));
+  dj_projection_slot Slots[ArrayCount(Paths)];
+  
+  EXPECT_TRUE(djReadNextDocument(Context) == 1);
+  EXPECT_TRUE(djReadProjection(Context, Projection, Slots) == 5);
+  EXPECT_TRUE(Slots[0].Type == djTYPE_S64 && Slots[0].S64 == 1);
+  EXPECT_TRUE(Slots[1].Type == djTYPE_STRING && strcmp(Slots[1].String.Data, "a\"b") == 0);
+  EXPECT_TRUE(Slots[2].Type == djTYPE_STRING && strcmp(Slots[2].String.Data, "y") == 0);
+  EXPECT_TRUE(Slots[3].Type == djTYPE_NULL);
+  EXPECT_TRUE(Slots[4].Type == djTYPE_NONE);
+  EXPECT_TRUE(Slots[5].Type == djTYPE_OBJECT);
+  
+  EXPECT_TRUE(djReadNextDocument(Context) == 1);
+  EXPECT_TRUE(djReadProjection(Context, Projection, Slots) == 4);
+  EXPECT_TRUE(Slots[0].Type == djTYPE_F64 && Slots[0].F64 == 2.5);
+  EXPECT_TRUE(Slots[1].Type == djTYPE_STRING && strcmp(Slots[1].String.Data, "c") == 0);
+  EXPECT_TRUE(Slots[2].Type == djTYPE_NONE);
+  EXPECT_TRUE(Slots[4].Type == djTYPE_BOOL && Slots[4].Bool == 1);
+  
+  EXPECT_TRUE(djReadNextDocument(Context) == 1);
+  EXPECT_TRUE(djReadProjection(Context, Projection, Slots) == 0);
+  
+  // Every path is found before "rest" which is skipped
+  EXPECT_TRUE(djReadNextDocument(Context) == 1);
+  EXPECT_TRUE(djReadProjection(Context, Projection, Slots) == 6);
+  EXPECT_TRUE(Slots[2].Type == djTYPE_STRING && strcmp(Slots[2].String.Data, "t") == 0);
+  EXPECT_TRUE(Slots[3].Type == djTYPE_S64 && Slots[3].S64 == 0);
+  
+  EXPECT_TRUE(djReadNextDocument(Context) == 0);
+  djDestroyProjection(Projection);
+}
+
+static const char TestReadProjectionLargeNumbers__Json[] = 
+  "{ \"a\": 12345678901234567890, \"b\": 1e400, \"c\": 1e20, \"d\": -7.5 }";
+void TestReadProjectionLargeNumbers(dj_read_context* Context) {
+  const char* Paths[] = { "/a", "/b", "/c", "/d" };
+  dj_projection* Projection = djInitializeProjection(Paths, ArrayCount(Paths));
+  dj_projection_slot Slots[ArrayCount(Paths)];
+  
+  // Numbers outside of the 64 bit range are floats with S64 set to 0
+  EXPECT_TRUE(djReadNextDocument(Context) == 1);
+  EXPECT_TRUE(djReadProjection(Context, Projection, Slots) == 4);
+  EXPECT_TRUE(Slots[0].Type == djTYPE_F64 && Slots[0].F64 == 12345678901234567890.0 && Slots[0].S64 == 0);
+  EXPECT_TRUE(Slots[1].Type == djTYPE_F64 && Slots[1].S64 == 0);
+  EXPECT_TRUE(Slots[2].Type == djTYPE_F64 && Slots[2].F64 == 1e20 && Slots[2].S64 == 0);
+  EXPECT_TRUE(Slots[3].Type == djTYPE_F64 && Slots[3].S64 == -7);
+  djDestroyProjection(Projection);
+}
+
+static const char TestReadStats__Json[] = "{ \"a\": \"x\\ny\", \"b\": 12, \"c\": 1.5 }";
+void TestReadStats(dj_read_context* Context) {
+  dj_string Key;
+  while (djReadKey(Context, &Key)) {
+    djReadSkipValue(Context);
+  }
+  EXPECT_TRUE(djReadGetStats(Context).BytesScanned == sizeof(TestReadStats__Json) - 1);
+  
+#ifdef DIR_JSON_STATS
+  dj_read_stats Stats = djReadGetStats(Context);
+  EXPECT_TRUE(Stats.StringsRead == 3);
+  EXPECT_TRUE(Stats.EscapesDecoded == 0);
+  EXPECT_TRUE(Stats.WhitespaceSkipped == 7);
+#endif
+  
+  // The bytes consumed before an error are still counted after it
+  dj_read_context* ErrorContext = djReadFromString("{ \"a\": 1, \"b\" 2 }");
+  while (djReadKey(ErrorContext, &Key)) {
+    djReadSkipValue(ErrorContext);
+  }
+  EXPECT_TRUE(djReadError(ErrorContext) && djReadGetStats(ErrorContext).BytesScanned == 14);
+  djReadDestroyContext(ErrorContext);
+}
+
+static const char TestReadProfile__Json[] = "{ \"a\": [ { \"b\": 1 }, { \"b\": 2, \"c\": [ ] } ], \"d\": \"x\" }";
+void TestReadProfile(dj_read_context* Context) {
+  dj_string Key;
+  EXPECT_TRUE(djReadMandatoryKey(Context, "a") == 1);
+  while (djReadArray(Context)) {
+    while (djReadKey(Context, &Key)) {
+      djReadSkipValue(Context);
+    }
+  }
+  EXPECT_TRUE(djReadMandatoryKey(Context, "d") == 1);
+  djReadString(Context);
+  EXPECT_TRUE(djReadObjectEnd(Context) == 1);
+  
+#ifdef DIR_JSON_PROFILE
+  FILE* File = tmpfile();
+  djReadProfileReport(Context, File, 10);
+  rewind(File);
+  char Report[1024];
+  size_t ReportLength = fread(Report, 1, sizeof(Report) - 1, File);
+  Report[ReportLength] = '\0';
+  fclose(File);
+  EXPECT_TRUE(strstr(Report, "2  /a/*/b\n") != 0);
+  EXPECT_TRUE(strstr(Report, "1  /a/*/c\n") != 0);
+  EXPECT_TRUE(strstr(Report, "1  /d\n") != 0);
+#endif
+}
+
+static const char TestReadProfileObjectEnd__Json[] = "{ \"u\": { \"id\": 1 }, \"x\": 2 }";
+void TestReadProfileObjectEnd(dj_read_context* Context) {
+  dj_string Key;
+  EXPECT_TRUE(djReadKey(Context, &Key) && strcmp(Key.Data, "u") == 0);
+  EXPECT_TRUE(djReadKey(Context, &Key) && strcmp(Key.Data, "id") == 0);
+  EXPECT_TRUE(djReadS64(Context) == 1);
+  EXPECT_TRUE(djReadObjectEnd(Context) == 1);
+  EXPECT_TRUE(djReadKey(Context, &Key) && strcmp(Key.Data, "x") == 0);
+  EXPECT_TRUE(djReadS64(Context) == 2);
+  EXPECT_TRUE(djReadObjectEnd(Context) == 1);
+  
+#ifdef DIR_JSON_PROFILE
+  FILE* File = tmpfile();
+  djReadProfileReport(Context, File, 10);
+  rewind(File);
+  char Line[256];
+  int FoundX = 0;
+  while (fgets(Line, sizeof(Line), File)) {
+    long long SelfTicks, TotalTicks;
+    if (sscanf(Line, "%lld %lld", &SelfTicks, &TotalTicks) != 2)
+      continue; // The header
+    EXPECT_TRUE(SelfTicks >= 0 && TotalTicks >= 0);
+    EXPECT_TRUE(strstr(Line, "/u/x") == 0);
+    FoundX |= strstr(Line, "  /x\n") != 0;
+  }
+  fclose(File);
+  EXPECT_TRUE(FoundX);
+#endif
+}
+
 #define ERROR_TEST(Name) { #Name, Name##__Json, Name##__Carrot, Name##__Message, Name }
 static test_error ErrorTests[] = {
   ERROR_TEST(TestReadExpectedArray),
@@ -210,14 +611,23 @@ static test_error ErrorTests[] = {
   ERROR_TEST(TestReadS64GotDecimal),
   ERROR_TEST(TestReadS64NegativeExponent),
   ERROR_TEST(TestReadS64EmptyExponent),
+  ERROR_TEST(TestReadMultipleLines),
   
   ERROR_TEST(TestReadF64IllegalStart),
   ERROR_TEST(TestReadF64EmptyFraction),
   ERROR_TEST(TestReadF64EmptyExponent),
+  ERROR_TEST(TestReadF64Hex),
+  
+  ERROR_TEST(TestReadDecimalTooManyDecimals),
+  ERROR_TEST(TestReadDecimalOverflow),
   
   ERROR_TEST(TestReadStringNotAString),
   ERROR_TEST(TestReadStringTooFewHex),
-  ERROR_TEST(TestReadStringTooBigUnicode),
+  ERROR_TEST(TestReadStringLoneHighSurrogate),
+  ERROR_TEST(TestReadStringLoneLowSurrogate),
+#ifdef DIR_JSON_VALIDATE_UTF8
+  ERROR_TEST(TestReadStringInvalidUtf8),
+#endif
   ERROR_TEST(TestReadStringIllegalEscapeSequence)
 };
 
@@ -228,9 +638,238 @@ static test_success SuccessTests[] = {
   SUCCESS_TEST(TestReadEmptyObjectInObject),
   SUCCESS_TEST(TestReadEmptyArray),
   SUCCESS_TEST(TestReadArray),
-  SUCCESS_TEST(TestReadNestedArrays)
+  SUCCESS_TEST(TestReadNestedArrays),
+  SUCCESS_TEST(TestReadStringUnicode),
+  SUCCESS_TEST(TestReadDecimal),
+  SUCCESS_TEST(TestReadNumberRaw),
+  SUCCESS_TEST(TestReadKeyIds),
+  SUCCESS_TEST(TestReadSkipValue),
+  SUCCESS_TEST(TestReadColumns),
+  SUCCESS_TEST(TestReadTape),
+  SUCCESS_TEST(TestReadTapeLargeIntegers),
+  SUCCESS_TEST(TestReadSeekPath),
+  SUCCESS_TEST(TestReadSeekPathMissing),
+  SUCCESS_TEST(TestReadProjection),
+  SUCCESS_TEST(TestReadProjectionLargeNumbers),
+  SUCCESS_TEST(TestReadStats),
+  SUCCESS_TEST(TestReadProfile),
+  SUCCESS_TEST(TestReadProfileObjectEnd)
+};
+
+
+void TestWriteDocument(dj_write_context* Context) {
+  djWriteStartObject(Context);
+  djWriteKey(Context, "a");
+  djWriteS64(Context, 1);
+  djWriteKey(Context, "b");
+  djWriteStartArray(Context);
+  djWriteBool(Context, 1);
+  djWriteNull(Context);
+  djWriteS64(Context, -200);
+  djWriteEndArray(Context);
+  djWriteKey(Context, "c");
+  djWriteString(Context, "hi");
+  djWriteEndObject(Context);
+}
+
+void TestWriteNumbers(dj_write_context* Context) {
+  djWriteStartArray(Context);
+  djWriteS64(Context, 0);
+  djWriteS64(Context, 127);
+  djWriteS64(Context, 128);
+  djWriteS64(Context, -32);
+  djWriteS64(Context, -33);
+  djWriteS64(Context, 65536);
+  djWriteF64(Context, 1.5);
+  djWriteEndArray(Context);
+}
+
+void TestWriteDecimals(dj_write_context* Context) {
+  djWriteStartArray(Context);
+  djWriteDecimal(Context, 1250, 2);
+  djWriteDecimal(Context, -5, 2);
+  djWriteDecimal(Context, 0, 3);
+  djWriteDecimal(Context, 42, 0);
+  djWriteDecimal(Context, INT64_MIN, 18);
+  djWriteEndArray(Context);
+}
+
+void TestWriteLongArray(dj_write_context* Context) {
+  djWriteStartArray(Context);
+  for (int Index = 0; Index < 20; Index++) {
+    djWriteS64(Context, 0);
+  }
+  djWriteEndArray(Context);
+}
+
+static const char TestWriteDocumentJson[]    = "{\"a\":1,\"b\":[true,null,-200],\"c\":\"hi\"}";
+static const char TestWriteDocumentMsgPack[] = "\x83\xa1" "a" "\x01\xa1" "b" "\x93\xc3\xc0\xd1\xff\x38\xa1" "c" "\xa2" "hi";
+static const char TestWriteDocumentCbor[]    = "\xbf\x61" "a" "\x01\x61" "b" "\x9f\xf5\xf6\x38\xc7\xff\x61" "c" "\x62" "hi" "\xff";
+static const char TestWriteNumbersMsgPack[]  = "\x97\x00\x7f\xcc\x80\xe0\xd0\xdf\xce\x00\x01\x00\x00"
+                                               "\xcb\x3f\xf8\x00\x00\x00\x00\x00\x00";
+static const char TestWriteNumbersCbor[]     = "\x9f\x00\x18\x7f\x18\x80\x38\x1f\x38\x20\x1a\x00\x01\x00\x00"
+                                               "\xfb\x3f\xf8\x00\x00\x00\x00\x00\x00\xff";
+static const char TestWriteDecimalsJson[]    = "[12.50,-0.05,0.000,42,-9.223372036854775808]";
+static const char TestWriteLongArrayMsgPack[] = "\xdc\x00\x14" "\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0";
+
+// Json output includes the null terminator written by djWriteFinalize
+#define WRITE_TEST(Name, Format, Expected) { #Name " (" #Format ")", Format, Expected, sizeof(Expected) - (Format != djFORMAT_JSON), Name }
+static test_write WriteTests[] = {
+  WRITE_TEST(TestWriteDocument,  djFORMAT_JSON,    TestWriteDocumentJson),
+  WRITE_TEST(TestWriteDocument,  djFORMAT_MSGPACK, TestWriteDocumentMsgPack),
+  WRITE_TEST(TestWriteDocument,  djFORMAT_CBOR,    TestWriteDocumentCbor),
+  WRITE_TEST(TestWriteDecimals,  djFORMAT_JSON,    TestWriteDecimalsJson),
+  WRITE_TEST(TestWriteNumbers,   djFORMAT_MSGPACK, TestWriteNumbersMsgPack),
+  WRITE_TEST(TestWriteNumbers,   djFORMAT_CBOR,    TestWriteNumbersCbor),
+  WRITE_TEST(TestWriteLongArray, djFORMAT_MSGPACK, TestWriteLongArrayMsgPack),
+};
+
+// Long strings makes sure that the 16 byte blocks are used when SIMD is available
+static test_validate ValidateTests[] = {
+  { "{ \"a\": [ 1, -2.5e+3, true, false, null ], \"b\": { } }", -1 },
+  { " [ [ ], [ [ ] ] ] \n", -1 },
+  { "\"0123456789 abcdef 0123456789 \\n\\u00e9\\\" caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80 0123456789 abcdef\"", -1 },
+  { "0", -1 },
+  { "", 0 },
+  { "[ 1, 2 ", 7 },
+  { "[ 1, 2 }", 7 },
+  { "{ \"a\" 1 }", 6 },
+  { "{ \"a\": 1, }", 10 },
+  { "{ 1: 2 }", 2 },
+  { "[ 01 ]", 3 },
+  { "[ 1. ]", 4 },
+  { "[ -e ]", 3 },
+  { "[ tru ]", 5 },
+  { "[ 1 ] 2", 6 },
+  { "\"0123456789 abcdef 0123456789 \\x 0123456789\"", 31 },
+  { "\"0123456789 abcdef 0123456789 \\u12g4 0123456789\"", 34 },
+  { "\"0123456789 abcdef 0123456789 \t 0123456789\"", 30 },
+  { "\"0123456789 abcdef 0123456789 \xc0\xaf 0123456789\"", 30 },
+  { "\"0123456789 abcdef 0123456789 \xed\xa0\x80 0123456789\"", 30 },
+  { "\"0123456789 abcdef 0123456789 \xe2\x82", 30 },
+  { "\"0123456789 abcdef 0123456789 0123456789", 40 },
+};
+
+static char WriteOutput[1024];
+static int  WriteOutputSize;
+void WriteOutputCallback(dj_write_context* Context, char* Data, int Size) {
+  assert(WriteOutputSize + Size <= ArrayCount(WriteOutput));
+  memcpy(WriteOutput + WriteOutputSize, Data, Size);
+  WriteOutputSize += Size;
+}
+
+void TestReadBinaryDocument(dj_read_context* Context) {
+  dj_string String;
+  EXPECT_TRUE(djReadNextIsObject(Context));
+  EXPECT_TRUE(djReadMandatoryKey(Context, "a") == 1);
+  EXPECT_TRUE(djReadS64(Context) == 1);
+  EXPECT_TRUE(djReadOptionalKey(Context, "x") == 0);
+  EXPECT_TRUE(djReadMandatoryKey(Context, "b") == 1);
+  EXPECT_TRUE(djReadArray(Context) == 1);
+  EXPECT_TRUE(djReadBool(Context) == 1);
+  EXPECT_TRUE(djReadArray(Context) == 1);
+  EXPECT_TRUE(djReadNextIsNull(Context));
+  djReadNull(Context);
+  EXPECT_TRUE(djReadArray(Context) == 1);
+  EXPECT_TRUE(djReadF64(Context) == -200.0);
+  EXPECT_TRUE(djReadArray(Context) == 0);
+  EXPECT_TRUE(djReadOptionalKey(Context, "c") == 1);
+  String = djReadString(Context);
+  EXPECT_TRUE(String.Length == 2 && memcmp(String.Data, "hi", 2) == 0);
+  EXPECT_TRUE(djReadObjectEnd(Context) == 1);
+}
+
+void TestReadBinarySkip(dj_read_context* Context) {
+  dj_string Key;
+  EXPECT_TRUE(djReadKey(Context, &Key) == 1);
+  djReadSkipValue(Context);
+  EXPECT_TRUE(djReadKey(Context, &Key) == 1);
+  EXPECT_TRUE(Key.Length == 1 && Key.Data[0] == 'b');
+  djReadSkipValue(Context);
+  EXPECT_TRUE(djReadKey(Context, &Key) == 1);
+  EXPECT_TRUE(djReadNextIsString(Context));
+  djReadSkipValue(Context);
+  EXPECT_TRUE(djReadKey(Context, &Key) == 0);
+}
+
+static const char TestReadCborExtras[] = "\x83\xf9\x3e\x00\xc1\x18\x64\x3b\x7f\xff\xff\xff\xff\xff\xff\xff";
+void TestReadBinaryCborExtras(dj_read_context* Context) {
+  EXPECT_TRUE(djReadArray(Context) == 1);
+  EXPECT_TRUE(djReadF64(Context) == 1.5);
+  EXPECT_TRUE(djReadArray(Context) == 1);
+  EXPECT_TRUE(djReadS64(Context) == 100);
+  EXPECT_TRUE(djReadArray(Context) == 1);
+  EXPECT_TRUE(djReadS64(Context) == -9223372036854775807LL - 1);
+  EXPECT_TRUE(djReadArray(Context) == 0);
+}
+
+static char PushLog[1024];
+static int  PushLogSize;
+static void PushLogAppend(const char* Format, ...) {
+  va_list Arguments;
+  va_start(Arguments, Format);
+  PushLogSize += vsnprintf(PushLog + PushLogSize, ArrayCount(PushLog) - PushLogSize, Format, Arguments);
+  va_end(Arguments);
+  assert(PushLogSize < ArrayCount(PushLog));
+}
+static void PushStartObject(dj_read_context* Context, void* Ptr)              { PushLogAppend("{ "); }
+static void PushEndObject(  dj_read_context* Context, void* Ptr)              { PushLogAppend("} "); }
+static void PushStartArray( dj_read_context* Context, void* Ptr)              { PushLogAppend("[ "); }
+static void PushEndArray(   dj_read_context* Context, void* Ptr)              { PushLogAppend("] "); }
+static void PushKey(        dj_read_context* Context, void* Ptr, dj_string V) { PushLogAppend("%s: ", V.Data); }
+static void PushString(     dj_read_context* Context, void* Ptr, dj_string V) { PushLogAppend("'%s' ", V.Data); }
+static void PushS64(        dj_read_context* Context, void* Ptr, dj_s64 V)    { PushLogAppend("%lld ", V); }
+static void PushF64(        dj_read_context* Context, void* Ptr, dj_f64 V)    { PushLogAppend("%g ", V); }
+static void PushBool(       dj_read_context* Context, void* Ptr, int V)       { PushLogAppend("%d ", V); }
+static void PushNull(       dj_read_context* Context, void* Ptr)              { PushLogAppend("null "); }
+static void PushEndDocument(dj_read_context* Context, void* Ptr)              { PushLogAppend("| "); }
+
+static const dj_push_callbacks PushCallbacks = { PushStartObject, PushEndObject, PushStartArray, PushEndArray,
+  PushKey, PushString, PushS64, PushF64, PushBool, PushNull, PushEndDocument };
+
+typedef struct {
+  const char* Json;
+  const char* Expected; // The events or the error
+} test_push;
+
+static test_push PushTests[] = {
+  { "{ \"a\": [1, -2.5e1, true, false, null, \"x\\u00e9\\ud83d\\ude00\"], \"b\\\"c\": {}, \"d\": [] } 42\n\"s\" 7", 
+    "{ a: [ 1 -25 1 0 null 'x\xc3\xa9\xf0\x9f\x98\x80' ] b\"c: { } d: [ ] } | 42 | 's' | 7 | " },
+  { "{ \"a\" 1 }", "A colon needs to follow the key for each member." },
+  { "[ 1, tru ]", "Expected a boolean ('true' or 'false'. )" },
+  { "[ 1, 2", "Reached end of the file before the end of the value. " },
+  { "[ \"abc", "Reached end of the file before closing the string. " },
 };
 
+typedef struct {
+  const char* Source;
+  const char* Patch;
+  const char* Expected;
+} test_merge_patch;
+
+// The examples from RFC 7386, untouched values are copied without being converted
+static test_merge_patch MergePatchTests[] = {
+  { "{\"a\":\"b\"}",                "{\"a\":\"c\"}",                    "{\"a\":\"c\"}" },
+  { "{\"a\":\"b\"}",                "{\"b\":\"c\"}",                    "{\"a\":\"b\",\"b\":\"c\"}" },
+  { "{\"a\":\"b\"}",                "{\"a\":null}",                     "{}" },
+  { "{\"a\":\"b\",\"b\":\"c\"}",      "{\"a\":null}",                     "{\"b\":\"c\"}" },
+  { "{\"a\":[\"b\"]}",              "{\"a\":\"c\"}",                    "{\"a\":\"c\"}" },
+  { "{\"a\":\"c\"}",                "{\"a\":[\"b\"]}",                  "{\"a\":[\"b\"]}" },
+  { "{\"a\":{\"b\":\"c\"}}",          "{\"a\":{\"b\":\"d\",\"c\":null}}",     "{\"a\":{\"b\":\"d\"}}" },
+  { "{\"a\":[{\"b\":\"c\"}]}",        "{\"a\":[1]}",                      "{\"a\":[1]}" },
+  { "[\"a\",\"b\"]",                "[\"c\",\"d\"]",                    "[\"c\",\"d\"]" },
+  { "{\"a\":\"b\"}",                "[\"c\"]",                          "[\"c\"]" },
+  { "{\"a\":\"foo\"}",              "null",                             "null" },
+  { "{\"a\":\"foo\"}",              "\"bar\"",                          "\"bar\"" },
+  { "{\"e\":null}",                 "{\"a\":1}",                        "{\"e\":null,\"a\":1}" },
+  { "[1,2]",                        "{\"a\":\"b\",\"c\":null}",             "{\"a\":\"b\"}" },
+  { "{}",                           "{\"a\":{\"bb\":{\"ccc\":null}}}",      "{\"a\":{\"bb\":{}}}" },
+  { " { \"n\" : 123456789012345678901234, \"l\": [ 1, { \"x\": \"\\n\" } ] } ", "{\"t\":[null,true]}",
+    "{\"n\":123456789012345678901234,\"l\":[1,{\"x\":\"\\n\"}],\"t\":[null,true]}" },
+  { " { } ", "{\"a\":0.0000001,\"b\":12345678901234567890,\"c\":1.5e300,\"d\":[-2E-7,10]}",
+    "{\"a\":0.0000001,\"b\":12345678901234567890,\"c\":1.5e300,\"d\":[-2E-7,10]}" },
+  { "{\"x\":\"\\u0002\"}",             "{\"a\":\"\\u001F\\t\\u007f\"}",       "{\"x\":\"\\u0002\",\"a\":\"\\u001f\\t\x7f\"}" },
+};
 
 void PrintEscapedError(const char* Msg) {
   while (*Msg) {
@@ -244,57 +883,593 @@ void PrintEscapedError(const char* Msg) {
   }
 }
 
+// Every json test is run both from a null terminated string and from an exact sized buffer without a terminator
+static dj_read_context* ReadTestJson(const char* Json, int FromBuffer, char** BufferOut) {
+  *BufferOut = 0;
+  if (!FromBuffer)
+    return djReadFromString(Json);
+  
+  size_t Length = strlen(Json);
+  *BufferOut = malloc(Length);
+  memcpy(*BufferOut, Json, Length);
+  return djReadFromBuffer(*BufferOut, Length);
+}
+
 int main(int argc, char* argv[]) {
   int TotalTestCases = 0;
   int FailedTestCases = 0;
   
   // Test error messages
-  for (int TestIndex = 0; TestIndex < ArrayCount(ErrorTests); TestIndex++) {
-    test_error* Test = &ErrorTests[TestIndex];
+  for (int TestIndex = 0; TestIndex < 2 * ArrayCount(ErrorTests); TestIndex++) {
+    test_error* Test = &ErrorTests[TestIndex / 2];
     
-    dj_read_context* Context = djReadFromString(Test->Json);
+    char* Buffer;
+    dj_read_context* Context = ReadTestJson(Test->Json, TestIndex % 2, &Buffer);
     
     Test->Function(Context);
     
+    // The error is expected to be on the last line, which is the only line shown
     int Line = 1;
+    const char* LastLine = Test->Json;
+    for (const char* Char = Test->Json; *Char; Char++) {
+      if (*Char == '\n') {
+        Line += 1;
+        LastLine = Char + 1;
+      }
+    }
     int Column = 1;
     while (Test->Carrot[Column - 1] != '^') ++Column;
     
     char ExpectedError[1024];
     size_t PrintCount = snprintf(ExpectedError, ArrayCount(ExpectedError), "ERROR(Line %d, Col %d): %s\n > %s\n > %s",
-                                 Line, Column, Test->Message, Test->Json, Test->Carrot);
+                                 Line, Column, Test->Message, LastLine, Test->Carrot);
     assert(PrintCount < ArrayCount(ExpectedError) - 1);
     
     const char* Error = djReadError(Context);
     int MessageNotEqual = Error ? strcmp(ExpectedError, Error) : 0; 
     if (!Error || MessageNotEqual) {
-      printf("Error test case '%s':\n", Test->Name);
+      printf("Error test case '%s'%s:\n", Test->Name, Buffer ? " (from buffer)" : "");
       printf("Json: '%s'\n", Test->Json);
       printf("ExpectedError: '"); PrintEscapedError(ExpectedError);                printf("'\n");
       printf("ActualError:   '"); PrintEscapedError(Error ? Error : "<no-error>"); printf("'\n");
       FailedTestCases += 1;
     }
+    djReadDestroyContext(Context);
+    free(Buffer);
     TotalTestCases += 1;
   }
   
   // Test correct parsing
-  for (int TestIndex = 0; TestIndex < ArrayCount(SuccessTests); TestIndex++) {
-    test_success* Test = &SuccessTests[TestIndex];
+  for (int TestIndex = 0; TestIndex < 2 * ArrayCount(SuccessTests); TestIndex++) {
+    test_success* Test = &SuccessTests[TestIndex / 2];
     
-    dj_read_context* Context = djReadFromString(Test->Json);
+    char* Buffer;
+    dj_read_context* Context = ReadTestJson(Test->Json, TestIndex % 2, &Buffer);
     
     Test->Function(Context);
     
     djReadEOF(Context);
     
     if (djReadError(Context)) {
-      printf("Succcess test case '%s':\n", Test->Name);
+      printf("Succcess test case '%s'%s:\n", Test->Name, Buffer ? " (from buffer)" : "");
       printf("Json: '%s'\n", Test->Json);
       printf("Error: '%s'\n", djReadError(Context));
       FailedTestCases += 1;
     }
+    djReadDestroyContext(Context);
+    free(Buffer);
+    TotalTestCases += 1;
+  }
+  
+  // Test writing, a small buffer is used to make sure flushing in the middle of a value works
+  for (int TestIndex = 0; TestIndex < ArrayCount(WriteTests); TestIndex++) {
+    test_write* Test = &WriteTests[TestIndex];
+    
+    WriteOutputSize = 0;
+    dj_write_context* Context = djWriteInitializeContextTargetCustom(WriteOutputCallback, 8);
+    djWriteSetFormat(Context, Test->Format);
+    
+    Test->Function(Context);
+    
+    djWriteFinalize(Context);
+    djWriteDestroyContext(Context);
+    
+    if (WriteOutputSize != Test->ExpectedSize || memcmp(WriteOutput, Test->Expected, WriteOutputSize) != 0) {
+      printf("Write test case '%s':\n", Test->Name);
+      printf("Expected %d bytes, got %d bytes:", Test->ExpectedSize, WriteOutputSize);
+      for (int ByteIndex = 0; ByteIndex < WriteOutputSize; ByteIndex++)
+        printf(" %02x", (unsigned char)WriteOutput[ByteIndex]);
+      printf("\n");
+      FailedTestCases += 1;
+    }
+    TotalTestCases += 1;
+  }
+  
+  // Test writing into a fixed buffer of every size, too small buffers should report the size needed
+  for (int TestIndex = 0; TestIndex < ArrayCount(WriteTests); TestIndex++) {
+    test_write* Test = &WriteTests[TestIndex];
+    int Reserved = Test->Format == djFORMAT_MSGPACK ? 4 : 0;
+    
+    for (int Size = 0; Size <= Test->ExpectedSize + Reserved; Size++) {
+      char* Buffer = malloc(Size + 1);
+      dj_write_context* Context = djWriteInitializeContextTargetBuffer(Buffer, Size);
+      djWriteSetFormat(Context, Test->Format);
+      
+      Test->Function(Context);
+      
+      char* Result = djWriteFinalize(Context);
+      dj_s64 RequiredSize = djWriteRequiredSize(Context);
+      int IsCorrect;
+      if (Result) {
+        IsCorrect = Result == Buffer && RequiredSize == Test->ExpectedSize && 
+          memcmp(Result, Test->Expected, Test->ExpectedSize) == 0;
+      } else {
+        IsCorrect = Size < Test->ExpectedSize + Reserved && RequiredSize == Test->ExpectedSize + Reserved && 
+          Context->Error;
+      }
+      djWriteDestroyContext(Context);
+      free(Buffer);
+      
+      if (!IsCorrect) {
+        printf("Write to buffer test case '%s' (size %d):\n", Test->Name, Size);
+        printf("Expected %d bytes, got %s and a required size of %lld\n", Test->ExpectedSize, 
+               Result ? "the output" : "no output", RequiredSize);
+        FailedTestCases += 1;
+        break;
+      }
+    }
+    TotalTestCases += 1;
+  }
+  
+  // Test reusing contexts, an unfinished or overflowed document is thrown away by the reset
+  {
+    char SmallBuffer[8];
+    dj_write_context* Contexts[] = { djWriteInitializeContextTargetString(8), 
+                                     djWriteInitializeContextTargetBuffer(SmallBuffer, sizeof(SmallBuffer)) };
+    size_t ExpectedLength = sizeof(TestWriteDocumentJson) - 1;
+    int IsCorrect = 1;
+    for (int Iteration = 0; Iteration < 3; Iteration++) {
+      dj_write_context* Context = Contexts[0];
+      if (Iteration == 1)
+        djWriteStartArray(Context);
+      djWriteReset(Context);
+      
+      TestWriteDocument(Context);
+      size_t Length;
+      const char* Result = djWriteFinalizeWithLength(Context, &Length);
+      IsCorrect &= Result && Length == ExpectedLength && memcmp(Result, TestWriteDocumentJson, Length + 1) == 0;
+      
+      Context = Contexts[1];
+      djWriteReset(Context);
+      TestWriteDocument(Context);
+      IsCorrect &= !djWriteFinalizeWithLength(Context, &Length) && Length == ExpectedLength;
+      djWriteReset(Context);
+      djWriteS64(Context, 123);
+      IsCorrect &= djWriteFinalizeWithLength(Context, &Length) == SmallBuffer && strcmp(SmallBuffer, "123") == 0;
+    }
+    
+    // djWriteFinalize gives the string to the caller, so the reset allocates a new one
+    char* Owned = djWriteFinalize(Contexts[0]);
+    djWriteReset(Contexts[0]);
+    TestWriteDocument(Contexts[0]);
+    IsCorrect &= strcmp(djWriteFinalizeWithLength(Contexts[0], 0), Owned) == 0;
+    free(Owned);
+    djWriteDestroyContext(Contexts[0]);
+    djWriteDestroyContext(Contexts[1]);
+    
+    if (!IsCorrect) {
+      printf("Write reset test case failed\n");
+      FailedTestCases += 1;
+    }
+    TotalTestCases += 1;
+  }
+  
+  // Test writing into segments, the output is compared with the string target
+  {
+    int IsCorrect = 1;
+    int Formats[] = { djFORMAT_JSON, djFORMAT_MSGPACK };
+    for (int FormatIndex = 0; FormatIndex < ArrayCount(Formats); FormatIndex++) {
+      dj_write_context* Expected = djWriteInitializeContextTargetString(0);
+      djWriteSetFormat(Expected, Formats[FormatIndex]);
+      TestWriteDocument(Expected);
+      size_t ExpectedLength;
+      const char* ExpectedOutput = djWriteFinalizeWithLength(Expected, &ExpectedLength);
+      
+      for (int SegmentSize = 1; SegmentSize <= 32; SegmentSize++) {
+        dj_write_context* Context = djWriteInitializeContextTargetSegments(SegmentSize);
+        djWriteSetFormat(Context, Formats[FormatIndex]);
+        for (int Iteration = 0; Iteration < 2; Iteration++) {
+          djWriteReset(Context);
+          TestWriteDocument(Context);
+          size_t Length;
+          IsCorrect &= !djWriteFinalizeWithLength(Context, &Length) && Length == ExpectedLength;
+          
+          int Count;
+          const dj_segment* Segments = djWriteGetSegments(Context, &Count);
+          size_t Offset = 0;
+          for (int Index = 0; Index < Count; Index++) {
+            IsCorrect &= Offset + Segments[Index].Length <= ExpectedLength && 
+                         memcmp(Segments[Index].Data, ExpectedOutput + Offset, Segments[Index].Length) == 0;
+            Offset += Segments[Index].Length;
+          }
+          IsCorrect &= Offset == ExpectedLength;
+          
+          char* Joined = djWriteJoinSegments(Context, &Length);
+          IsCorrect &= Length == ExpectedLength && memcmp(Joined, ExpectedOutput, Length) == 0 && !Joined[Length];
+          free(Joined);
+        }
+        djWriteDestroyContext(Context);
+      }
+      djWriteDestroyContext(Expected);
+    }
+    
+    if (!IsCorrect) {
+      printf("Write segments test case failed\n");
+      FailedTestCases += 1;
+    }
+    TotalTestCases += 1;
+  }
+  
+  { // Nesting MessagePack containers deeper than DIR_JSON_WRITE_MAX_DEPTH is reported as an error
+    dj_write_context* Context = djWriteInitializeContextTargetString(0);
+    djWriteSetFormat(Context, djFORMAT_MSGPACK);
+    int Depth = DIR_JSON_WRITE_MAX_DEPTH + 16;
+    for (int Index = 0; Index < Depth; Index++)
+      djWriteStartArray(Context);
+    djWriteS64(Context, 1);
+    for (int Index = 0; Index < Depth; Index++)
+      djWriteEndArray(Context);
+    
+    djWriteFinalizeWithLength(Context, 0);
+    if (!Context->Error || strcmp(Context->Error, "Containers are nested too deeply. ") != 0) {
+      printf("Write nesting too deep test case failed\n");
+      FailedTestCases += 1;
+    }
+    TotalTestCases += 1;
+    djWriteDestroyContext(Context);
+  }
+  
+  // Test reading binary formats, the input is produced by the writer
+  int BinaryFormats[] = { djFORMAT_MSGPACK, djFORMAT_CBOR };
+  for (int FormatIndex = 0; FormatIndex < ArrayCount(BinaryFormats); FormatIndex++) {
+    void (*ReadFunctions[])(dj_read_context*) = { TestReadBinaryDocument, TestReadBinarySkip };
+    for (int FunctionIndex = 0; FunctionIndex < ArrayCount(ReadFunctions); FunctionIndex++) {
+      WriteOutputSize = 0;
+      dj_write_context* WriteContext = djWriteInitializeContextTargetCustom(WriteOutputCallback, 0);
+      djWriteSetFormat(WriteContext, BinaryFormats[FormatIndex]);
+      TestWriteDocument(WriteContext);
+      djWriteFinalize(WriteContext);
+      djWriteDestroyContext(WriteContext);
+      
+      dj_read_context* Context = djReadFromBinary(WriteOutput, WriteOutputSize, BinaryFormats[FormatIndex]);
+      ReadFunctions[FunctionIndex](Context);
+      djReadEOF(Context);
+      
+      if (djReadError(Context)) {
+        printf("Binary read test case %d (format %d):\n", FunctionIndex, BinaryFormats[FormatIndex]);
+        printf("Error: '%s'\n", djReadError(Context));
+        FailedTestCases += 1;
+      }
+      djReadDestroyContext(Context);
+      TotalTestCases += 1;
+    }
+  }
+  {
+    dj_read_context* Context = djReadFromBinary(TestReadCborExtras, sizeof(TestReadCborExtras) - 1, djFORMAT_CBOR);
+    TestReadBinaryCborExtras(Context);
+    djReadEOF(Context);
+    if (djReadError(Context)) {
+      printf("Binary read test case 'TestReadBinaryCborExtras':\n");
+      printf("Error: '%s'\n", djReadError(Context));
+      FailedTestCases += 1;
+    }
+    djReadDestroyContext(Context);
+    TotalTestCases += 1;
+  }
+  
+  // Test validation
+  for (int TestIndex = 0; TestIndex < ArrayCount(ValidateTests); TestIndex++) {
+    test_validate* Test = &ValidateTests[TestIndex];
+    size_t ErrorOffset = 0;
+    int IsValid = djValidate(Test->Json, strlen(Test->Json), &ErrorOffset);
+    if (IsValid != (Test->ErrorOffset < 0) || (!IsValid && ErrorOffset != (size_t)Test->ErrorOffset)) {
+      printf("Validate test case %d:\n", TestIndex);
+      printf("Json: '%s'\n", Test->Json);
+      printf("Expected %s, got %s at %d\n", Test->ErrorOffset < 0 ? "valid" : "invalid", IsValid ? "valid" : "invalid",
+             (int)ErrorOffset);
+      FailedTestCases += 1;
+    }
+    TotalTestCases += 1;
+  }
+  
+  // Test the push parser, the input is fed in chunks of every size from 1 byte to all of it
+  for (int TestIndex = 0; TestIndex < ArrayCount(PushTests); TestIndex++) {
+    test_push* Test = &PushTests[TestIndex];
+    size_t Length = strlen(Test->Json);
+    for (size_t ChunkSize = 1; ChunkSize <= Length; ChunkSize++) {
+      PushLogSize = 0;
+      PushLog[0] = '\0';
+      dj_read_context* Context = djReadPush(&PushCallbacks, 0);
+      for (size_t Offset = 0; Offset < Length; Offset += ChunkSize) {
+        // Each chunk is copied to make sure nothing is read from it after djReadFeed returns
+        size_t Count = Length - Offset < ChunkSize ? Length - Offset : ChunkSize;
+        char* Chunk = malloc(Count);
+        memcpy(Chunk, Test->Json + Offset, Count);
+        djReadFeed(Context, Chunk, Count);
+        free(Chunk);
+      }
+      djReadFeedEnd(Context);
+      EXPECT_TRUE(djReadError(Context) || djReadGetStats(Context).BytesScanned == Length);
+      
+      const char* Error = djReadError(Context);
+      const char* Actual = Error ? strstr(Error, "): ") + 3 : PushLog;
+      if (strncmp(Actual, Test->Expected, strlen(Test->Expected)) != 0) {
+        printf("Push test case %d (chunk size %d):\n", TestIndex, (int)ChunkSize);
+        printf("Expected: '%s'\n", Test->Expected);
+        printf("Actual:   '%s'\n", Actual);
+        FailedTestCases += 1;
+        djReadDestroyContext(Context);
+        break;
+      }
+      djReadDestroyContext(Context);
+    }
+    TotalTestCases += 1;
+  }
+  
+  // Test copying values, the copy is compared with writing the same value inside of an object
+  for (int Pretty = 0; Pretty < 2; Pretty++) {
+    int IsCorrect = 1;
+    dj_write_context* Expected = djWriteInitializeContextTargetString(0);
+    djWriteSetPrettyPrint(Expected, Pretty);
+    djWriteStartObject(Expected);
+    djWriteKey(Expected, "x");
+    TestWriteDocument(Expected);
+    djWriteKey(Expected, "y");
+    djWriteStartArray(Expected);
+    djWriteEndArray(Expected);
+    djWriteEndObject(Expected);
+    const char* ExpectedOutput = djWriteFinalizeWithLength(Expected, 0);
+    
+    const char* Sources[] = { TestWriteDocumentJson, "\n{ \"a\" : 1 ,\r\n\t\"b\":[ true , null,-200 ], \"c\" :\"hi\" }  " };
+    for (int SourceIndex = 0; SourceIndex < ArrayCount(Sources); SourceIndex++) {
+      dj_read_context* Source = djReadFromString(Sources[SourceIndex]);
+      dj_write_context* Output = djWriteInitializeContextTargetString(0);
+      djWriteSetPrettyPrint(Output, Pretty);
+      djWriteStartObject(Output);
+      djWriteKey(Output, "x");
+      IsCorrect &= djCopyValue(Source, Output);
+      djWriteKey(Output, "y");
+      djWriteStartArray(Output);
+      djWriteEndArray(Output);
+      djWriteEndObject(Output);
+      djReadEOF(Source);
+      IsCorrect &= !djReadError(Source) && strcmp(djWriteFinalizeWithLength(Output, 0), ExpectedOutput) == 0;
+      djWriteDestroyContext(Output);
+      djReadDestroyContext(Source);
+    }
+    djWriteDestroyContext(Expected);
+    
+    if (!IsCorrect) {
+      printf("Copy value test case failed (pretty print %d)\n", Pretty);
+      FailedTestCases += 1;
+    }
+    TotalTestCases += 1;
+  }
+  
+  { // CBOR infinity and NaN (half floats) can't be copied to json
+    const unsigned char NonFinite[][3] = { { 0xF9, 0x7C, 0x00 }, { 0xF9, 0xFC, 0x00 }, { 0xF9, 0x7E, 0x00 } };
+    int IsCorrect = 1;
+    for (int Index = 0; Index < ArrayCount(NonFinite); Index++) {
+      dj_read_context* Source = djReadFromBinary(NonFinite[Index], sizeof(NonFinite[Index]), djFORMAT_CBOR);
+      dj_write_context* Output = djWriteInitializeContextTargetString(0);
+      IsCorrect &= !djCopyValue(Source, Output) && djReadError(Source) != 0;
+      djWriteDestroyContext(Output);
+      djReadDestroyContext(Source);
+    }
+    
+    if (!IsCorrect) {
+      printf("Copy non-finite value test case failed\n");
+      FailedTestCases += 1;
+    }
+    TotalTestCases += 1;
+  }
+  
+  // Test merge patches, both with the byte for byte copy and (through CBOR) the copy that converts each value
+  for (int TestIndex = 0; TestIndex < ArrayCount(MergePatchTests); TestIndex++) {
+    test_merge_patch* Test = &MergePatchTests[TestIndex];
+    dj_read_context* PatchContext = djReadFromString(Test->Patch);
+    dj_tape* Patch = djReadTape(PatchContext);
+    
+    dj_read_context* Source = djReadFromString(Test->Source);
+    dj_write_context* Output = djWriteInitializeContextTargetString(0);
+    int IsCorrect = djMergePatch(Source, Patch, Output);
+    djReadEOF(Source);
+    const char* Result = djWriteFinalizeWithLength(Output, 0);
+    IsCorrect &= !djReadError(Source) && strcmp(Result, Test->Expected) == 0;
+    djReadDestroyContext(Source);
+    
+    if (IsCorrect && strchr(Test->Source, ' ') == 0) {
+      Source = djReadFromString(Test->Source);
+      dj_write_context* Cbor = djWriteInitializeContextTargetString(0);
+      djWriteSetFormat(Cbor, djFORMAT_CBOR);
+      IsCorrect &= djMergePatch(Source, Patch, Cbor);
+      size_t CborLength;
+      const char* CborData = djWriteFinalizeWithLength(Cbor, &CborLength);
+      djReadDestroyContext(Source);
+      
+      // An empty patch copies objects and replaces anything else with an empty object
+      dj_read_context* EmptyPatchContext = djReadFromString("{}");
+      dj_tape* EmptyPatch = djReadTape(EmptyPatchContext);
+      Source = djReadFromBinary(CborData, CborLength, djFORMAT_CBOR);
+      djWriteReset(Output);
+      IsCorrect &= djMergePatch(Source, EmptyPatch, Output);
+      Result = djWriteFinalizeWithLength(Output, 0);
+      IsCorrect &= strcmp(Result, Test->Expected[0] == '{' ? Test->Expected : "{}") == 0;
+      djReadDestroyContext(Source);
+      djDestroyTape(EmptyPatch);
+      djReadDestroyContext(EmptyPatchContext);
+      djWriteDestroyContext(Cbor);
+    }
+    
+    if (!IsCorrect) {
+      printf("Merge patch test case %d failed:\n", TestIndex);
+      printf("Expected: '%s'\nGot: '%s'\n", Test->Expected, Result);
+      FailedTestCases += 1;
+    }
+    djWriteDestroyContext(Output);
+    djDestroyTape(Patch);
+    djReadDestroyContext(PatchContext);
+    TotalTestCases += 1;
+  }
+  
+  // Test the array index, each element is read through a saved index with a stride that doesn't divide the count
+  {
+    const char* FilePath  = "dirjson_test_array.json";
+    const char* IndexPath = "dirjson_test_array.json.idx";
+    FILE* File = fopen(FilePath, "wb");
+    fputs("[ { \"id\": 0, \"s\": \",]\" },\n", File);
+    for (int Element = 1; Element < 10; Element++)
+      fprintf(File, "  { \"id\": %d, \"s\": \",]\" }%s\n", Element, Element < 9 ? "," : "");
+    fputs("]\n", File);
+    fclose(File);
+    
+    dj_read_context* Context = djReadOpenAndReadFile(FilePath);
+    dj_array_index* Index = djBuildArrayIndex(Context, 3);
+    djReadDestroyContext(Context);
+    int IsCorrect = Index && djArrayIndexCount(Index) == 10 && djSaveArrayIndex(Index, IndexPath);
+    if (Index)
+      djDestroyArrayIndex(Index);
+    
+    Index = djLoadArrayIndex(IndexPath);
+    IsCorrect &= Index != 0 && !djLoadArrayIndex(FilePath);
+    for (int Element = 0; IsCorrect && Element < 10; Element++) {
+      Context = djReadFromArrayIndex(FilePath, Index, Element);
+      int Expected = Element;
+      while (djReadArray(Context)) {
+        IsCorrect &= djReadMandatoryKey(Context, "id") && djReadS64(Context) == Expected++;
+        djReadMandatoryKey(Context, "s");
+        djReadString(Context);
+        djReadObjectEnd(Context);
+      }
+      djReadEOF(Context);
+      IsCorrect &= !djReadError(Context) && Expected == (Element < 9 ? (Element / 3 + 1) * 3 : 10);
+      djReadDestroyContext(Context);
+    }
+    if (Index)
+      djDestroyArrayIndex(Index);
+    remove(FilePath);
+    remove(IndexPath);
+    
+    if (!IsCorrect) {
+      printf("Array index test case failed\n");
+      FailedTestCases += 1;
+    }
+    TotalTestCases += 1;
+  }
+  
+#ifdef DIR_JSON_ZLIB
+  // Test gzip round trip, the small buffer makes the writer compress several blocks
+  {
+    const char* FilePath = "dirjson_test.json.gz";
+    dj_write_context* WriteContext = djWriteInitializeContextTargetGzipFilePath(FilePath, 8, 6);
+    TestWriteDocument(WriteContext);
+    djWriteFinalize(WriteContext);
+    const char* WriteError = WriteContext->Error;
+    djWriteDestroyContext(WriteContext);
+    
+    dj_read_context* Context = djReadOpenAndReadGzipFile(FilePath);
+    TestReadBinaryDocument(Context);
+    djReadEOF(Context);
+    if (WriteError || djReadError(Context)) {
+      printf("Gzip test case:\n");
+      printf("Error: '%s'\n", WriteError ? WriteError : djReadError(Context));
+      FailedTestCases += 1;
+    }
+    djReadDestroyContext(Context);
+    remove(FilePath);
+    TotalTestCases += 1;
+  }
+  
+  // Test feeding a gzip file to the push parser
+  {
+    const char* FilePath = "dirjson_test_push.json.gz";
+    dj_write_context* WriteContext = djWriteInitializeContextTargetGzipFilePath(FilePath, 8, 6);
+    djWriteStartArray(WriteContext);
+    djWriteS64(WriteContext, 1);
+    djWriteString(WriteContext, "a");
+    djWriteStartObject(WriteContext);
+    djWriteKey(WriteContext, "b");
+    djWriteBool(WriteContext, 1);
+    djWriteEndObject(WriteContext);
+    djWriteEndArray(WriteContext);
+    djWriteFinalize(WriteContext);
+    djWriteDestroyContext(WriteContext);
+    
+    PushLogSize = 0;
+    PushLog[0] = '\0';
+    dj_read_context* Context = djReadPush(&PushCallbacks, 0);
+    int IsCorrect = djReadFeedGzipFile(Context, FilePath) && strcmp(PushLog, "[ 1 'a' { b: 1 } ] | ") == 0;
+    djReadDestroyContext(Context);
+    
+    Context = djReadPush(&PushCallbacks, 0);
+    IsCorrect &= !djReadFeedGzipFile(Context, "dirjson_test_missing.json.gz") && djReadError(Context);
+    djReadDestroyContext(Context);
+    remove(FilePath);
+    
+    if (!IsCorrect) {
+      printf("Gzip push test case failed\n");
+      FailedTestCases += 1;
+    }
+    TotalTestCases += 1;
+  }
+#endif
+  
+#ifdef DIR_JSON_MMAP
+  // Test the memory mapped target, the output spans several windows of a single page
+  {
+    const char* FilePath = "dirjson_test_mapped.bin";
+    int IsCorrect = 1;
+    int Formats[] = { djFORMAT_JSON, djFORMAT_MSGPACK };
+    for (int FormatIndex = 0; FormatIndex < ArrayCount(Formats); FormatIndex++) {
+      dj_write_context* Contexts[] = { djWriteInitializeContextTargetString(0), 
+                                       djWriteInitializeContextTargetMappedFilePath(FilePath, 1) };
+      for (int ContextIndex = 0; ContextIndex < ArrayCount(Contexts); ContextIndex++) {
+        dj_write_context* Context = Contexts[ContextIndex];
+        djWriteSetFormat(Context, Formats[FormatIndex]);
+        djWriteStartArray(Context);
+        for (int Index = 0; Index < 2000; Index++) {
+          if (Index == 1000)
+            djWriteStartArray(Context);
+          djWriteS64(Context, Index * 7919);
+          djWriteString(Context, "Padding");
+        }
+        djWriteEndArray(Context);
+        djWriteEndArray(Context);
+      }
+      
+      size_t ExpectedLength, Length;
+      const char* Expected = djWriteFinalizeWithLength(Contexts[0], &ExpectedLength);
+      IsCorrect &= !djWriteFinalizeWithLength(Contexts[1], &Length) && !Contexts[1]->Error && Length == ExpectedLength;
+      
+      FILE* File = fopen(FilePath, "rb");
+      char* Data = malloc(ExpectedLength + 1);
+      IsCorrect &= File && fread(Data, 1, ExpectedLength + 1, File) == ExpectedLength && 
+                   memcmp(Data, Expected, ExpectedLength) == 0;
+      if (File)
+        fclose(File);
+      free(Data);
+      djWriteDestroyContext(Contexts[0]);
+      djWriteDestroyContext(Contexts[1]);
+    }
+    remove(FilePath);
+    
+    if (!IsCorrect) {
+      printf("Memory mapped write test case failed\n");
+      FailedTestCases += 1;
+    }
     TotalTestCases += 1;
   }
+#endif
   
   if (FailedTestCases) {
     printf("Failure!\n %d failed out of %d total test case(s).\n", FailedTestCases, TotalTestCases);